@@ -0,0 +1,112 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "concol_hexdump.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr std::size_t rounds{5};
+
+double mb_per_second(const std::vector<unsigned char>& input,
+                     std::size_t& total) {
+  hexdump_renderer renderer{};
+  std::string out{};
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i{}; i < rounds; ++i) {
+    out.clear();
+    renderer.render(input.data(), input.size(), out);
+    total += out.size();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return double(input.size() * rounds) /
+         std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+// The ad-hoc loop: one add_* call and one snprintf per byte.
+double mb_per_second_per_byte(const std::vector<unsigned char>& input,
+                              std::size_t& total) {
+  auto start = std::chrono::steady_clock::now();
+  color c{};
+  char hex[4]{};
+  for (const auto byte : input) {
+    std::snprintf(hex, sizeof(hex), "%02x ", byte);
+    const std::string_view cell{hex, 3};
+    if (byte == 0) {
+      c.add_black(cell);
+    } else if (byte >= 0x20 && byte < 0x7F) {
+      c.add_cyan(cell);
+    } else if (byte < 0x80) {
+      c.add_green(cell);
+    } else {
+      c.add_yellow(cell);
+    }
+  }
+  total += c.to_string().size();
+  auto stop = std::chrono::steady_clock::now();
+  return double(input.size()) /
+         std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+}  // namespace
+
+int main() {
+  color::set_enabled(true);
+  // Packet-like data: text headers, zero padding and binary payload.
+  std::vector<unsigned char> mixed{};
+  std::vector<unsigned char> text{};
+  unsigned seed{1};
+  while (mixed.size() < (16u << 20)) {
+    for (const char ch : std::string{"GET /index.html HTTP/1.1\r\nHost: a\r\n"}) {
+      mixed.push_back(static_cast<unsigned char>(ch));
+    }
+    mixed.insert(mixed.end(), 24, 0);
+    for (int i{}; i < 64; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      mixed.push_back(static_cast<unsigned char>(seed >> 16));
+    }
+  }
+  for (std::size_t i{}; i < mixed.size(); ++i) {
+    text.push_back(static_cast<unsigned char>('a' + i % 26));
+  }
+  std::printf("input %zu MB each\n", mixed.size() >> 20);
+
+  std::size_t total{};
+  std::printf("text          %8.1f MB/s\n", mb_per_second(text, total));
+  std::printf("mixed         %8.1f MB/s\n", mb_per_second(mixed, total));
+  const std::vector<unsigned char> small(mixed.begin(),
+                                         mixed.begin() + (1u << 20));
+  std::printf("per-byte add  %8.1f MB/s (1 MB)\n",
+              mb_per_second_per_byte(small, total));
+  std::printf("checksum %zu\n", total);
+  return 0;
+}
@@ -0,0 +1,85 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "concol_highlight.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr std::size_t rounds{10};
+constexpr std::size_t chunk{64 * 1024};
+
+double gb_per_second(const std::string& input, std::size_t& total) {
+  std::string out{};
+  out.reserve(input.size() * 2);
+  const std::string_view view{input};
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i{}; i < rounds; ++i) {
+    out.clear();
+    structured_highlighter highlighter{};
+    for (std::size_t pos{}; pos < view.size(); pos += chunk) {
+      highlighter.feed(view.substr(pos, chunk), out);
+    }
+    highlighter.finish(out);
+    total += out.size();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return double(input.size() * rounds) /
+         std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+}  // namespace
+
+int main() {
+  color::set_enabled(true);
+  std::string json{};
+  std::string logfmt{};
+  for (std::size_t i{}; json.size() < (64u << 20); ++i) {
+    const auto id = std::to_string(i);
+    json += "{\"time\":\"2024-05-01T12:00:00.123Z\",\"level\":\"info\","
+            "\"msg\":\"request completed for client 10.0.0.1 with a "
+            "response body of 4096 bytes\",\"path\":\"/api/v1/items/";
+    json += id;
+    json += "\",\"status\":200,\"duration_ms\":12.5,\"cached\":false}\n";
+    logfmt += "time=2024-05-01T12:00:00.123Z level=info msg=\"request "
+              "completed for client 10.0.0.1 with a response body of 4096 "
+              "bytes\" path=/api/v1/items/";
+    logfmt += id;
+    logfmt += " status=200 duration_ms=12.5 cached=false\n";
+  }
+  std::printf("input %zu MB each\n", json.size() >> 20);
+
+  std::size_t total{};
+  std::printf("json lines    %8.2f GB/s\n", gb_per_second(json, total));
+  std::printf("logfmt        %8.2f GB/s\n", gb_per_second(logfmt, total));
+  std::printf("checksum %zu\n", total);
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include "concol.h"
+
+using namespace concol;
+using namespace concol_literals;
+
+namespace {
+
+constexpr std::size_t iterations{200000};
+constexpr std::size_t appends{64};
+
+template <typename Func>
+double ns_per_call(Func&& func) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i{}; i < iterations; ++i) {
+    func();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+         double(iterations * appends);
+}
+
+}  // namespace
+
+int main() {
+#ifdef CONCOL_HEADER_ONLY
+  std::printf("mode: header-only\n");
+#else
+  std::printf("mode: static library\n");
+#endif
+  std::size_t total{};
+  color buffer{};
+
+  auto add_char = ns_per_call([&] {
+    buffer.clear();
+    for (std::size_t i{}; i < appends; ++i) {
+      buffer.add_blue('x');
+    }
+    total += buffer.to_string().size();
+  });
+  std::printf("add_blue(char)         %8.2f ns/call\n", add_char);
+
+  auto add_c_str = ns_per_call([&] {
+    buffer.clear();
+    for (std::size_t i{}; i < appends; ++i) {
+      buffer.add_green_bright("value");
+    }
+    total += buffer.to_string().size();
+  });
+  std::printf("add_green_bright(str)  %8.2f ns/call\n", add_c_str);
+
+  auto add_plain = ns_per_call([&] {
+    buffer.clear();
+    for (std::size_t i{}; i < appends; ++i) {
+      buffer.add(',');
+    }
+    total += buffer.to_string().size();
+  });
+  std::printf("add(char)              %8.2f ns/call\n", add_plain);
+
+  auto literal = ns_per_call([&] {
+    for (std::size_t i{}; i < appends; ++i) {
+      total += "value"_red.size();
+    }
+  });
+  std::printf("\"value\"_red            %8.2f ns/call\n", literal);
+
+  std::printf("checksum %zu\n", total);
+  return 0;
+}
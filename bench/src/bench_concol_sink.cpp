@@ -0,0 +1,134 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "concol_uring.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr std::size_t total_bytes{256u << 20};
+
+// Write syscalls of the process, from /proc/self/io; 0 if unavailable.
+unsigned long long write_syscalls() {
+  std::ifstream io{"/proc/self/io"};
+  std::string key{};
+  unsigned long long value{};
+  while (io >> key >> value) {
+    if (key == "syscw:") return value;
+  }
+  return 0;
+}
+
+template <typename Func>
+double mb_per_second(Func&& func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto stop = std::chrono::steady_clock::now();
+  return double(total_bytes >> 20) /
+         std::chrono::duration<double>(stop - start).count();
+}
+
+void print_lines(std::size_t line_size) {
+  for (std::size_t i{}, size{}; size < total_bytes; ++i, size += line_size) {
+    color::printf("{+green}INFO {} request {cyan}/api/v1/items/%08zu{} "
+                  "completed in 12.5 ms with status 200\n",
+                  i);
+  }
+}
+
+// Already rendered lines, so that formatting does not hide the sink cost.
+void write_lines(const std::string& line) {
+  for (std::size_t size{}; size < total_bytes; size += line.size()) {
+    color::write(line.data(), line.size());
+  }
+}
+
+void report(const char* name, double rate, unsigned long long syscalls) {
+  std::printf("%-22s %8.1f MB/s %10.1f syscalls/MB\n", name, rate,
+              double(syscalls) / double(total_bytes >> 20));
+}
+
+}  // namespace
+
+// Usage: bench_concol_sink [<file>]; the file is overwritten and removed.
+// It should live on the storage under test rather than on tmpfs.
+int main(int argc, char* argv[]) {
+  const char* path{argc > 1 ? argv[1] : "bench_concol_sink.out"};
+  color::set_enabled(true);
+  const auto line = color::to_string(
+      "{+green}INFO {} request {cyan}/api/v1/items/%08zu{} "
+      "completed in 12.5 ms with status 200\n",
+      std::size_t{0});
+  for (const bool rendered : {false, true}) {
+    std::printf(rendered ? "color::write\n" : "color::printf\n");
+    const auto run = [&] {
+      if (rendered) {
+        write_lines(line);
+      } else {
+        print_lines(line.size());
+      }
+    };
+    {
+      std::FILE* stream = std::fopen(path, "w");
+      if (stream == nullptr) {
+        std::perror(path);
+        return 1;
+      }
+      color::set_ostream(stream);
+      const auto before = write_syscalls();
+      const auto rate = mb_per_second([&] {
+        run();
+        std::fflush(stream);
+      });
+      report("  stdio", rate, write_syscalls() - before);
+      color::set_ostream();
+      std::fclose(stream);
+    }
+    for (const bool use_io_uring : {true, false}) {
+      std::FILE* stream = std::fopen(path, "w");
+      uring_sink sink{fileno(stream), 256 * 1024, 8, use_io_uring};
+      sink.install();
+      const auto rate = mb_per_second([&] {
+        run();
+        sink.flush();
+      });
+      color::set_sink();
+      report(sink.uses_io_uring() ? "  uring_sink io_uring"
+                                  : "  uring_sink writev",
+             rate, sink.syscalls());
+      std::fclose(stream);
+    }
+  }
+
+  std::remove(path);
+  return 0;
+}
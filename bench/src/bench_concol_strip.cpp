@@ -0,0 +1,106 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "concol_text.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr std::size_t rounds{20};
+constexpr std::size_t chunk{64 * 1024};
+
+template <typename Func>
+double gb_per_second(std::size_t bytes, Func&& func) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i{}; i < rounds; ++i) {
+    func();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return double(bytes * rounds) /
+         std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+}  // namespace
+
+int main() {
+  const char* const levels[]{"\x1b[0;32;1mINFO \x1b[0m",
+                             "\x1b[0;33;1mWARN \x1b[0m",
+                             "\x1b[0;31;1mERROR\x1b[0m"};
+  std::string input{};
+  for (std::size_t i{}; input.size() < (64u << 20); ++i) {
+    input += levels[i % 3];
+    input += " request \x1b[0;36m/api/v1/items/";
+    input += std::to_string(i);
+    input += "\x1b[0m completed in 12.5 ms for client 10.0.0.1 with status ";
+    input += "200 and 4096 bytes of payload\n";
+  }
+  std::printf("input %zu MB\n", input.size() >> 20);
+
+  std::size_t total{};
+  std::string copy(input.size(), '\0');
+  const auto memcpy_rate = gb_per_second(input.size(), [&] {
+    std::memcpy(&copy[0], input.data(), input.size());
+    total += std::size_t(copy[copy.size() / 2]);
+  });
+  std::printf("memcpy                 %8.2f GB/s\n", memcpy_rate);
+
+  const auto in_place = gb_per_second(input.size(), [&] {
+    std::memcpy(&copy[0], input.data(), input.size());
+    total += strip_ansi(&copy[0], copy.size());
+  });
+  std::printf("strip_ansi in place    %8.2f GB/s (with the copy)\n", in_place);
+
+  std::string out{};
+  out.reserve(input.size());
+  const auto streaming = gb_per_second(input.size(), [&] {
+    out.clear();
+    ansi_stripper stripper{};
+    const std::string_view view{input};
+    for (std::size_t pos{}; pos < view.size(); pos += chunk) {
+      stripper.feed(view.substr(pos, chunk), out);
+    }
+    total += out.size();
+  });
+  std::printf("ansi_stripper 64 KB    %8.2f GB/s\n", streaming);
+
+  // Already plain text: the scan never leaves the SIMD loop.
+  const auto plain_input = strip_ansi(input);
+  const auto plain = gb_per_second(plain_input.size(), [&] {
+    out.clear();
+    ansi_stripper{}.feed(plain_input, out);
+    total += out.size();
+  });
+  std::printf("ansi_stripper plain    %8.2f GB/s\n", plain);
+
+  std::printf("checksum %zu\n", total);
+  return 0;
+}
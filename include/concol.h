@@ -32,8 +32,20 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define CONCOL_NO_STRING_VIEW
 #endif
 
+#ifdef CONCOL_HEADER_ONLY
+#if __cplusplus < 201703L
+#error "CONCOL_HEADER_ONLY requires the ISO C++ 2017 standard or later."
+#endif
+#define CONCOL_INLINE inline
+#else
+#define CONCOL_INLINE
+#endif
+
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <vector>
 #ifndef CONCOL_NO_STRING_VIEW
 #include <string_view>
 #endif
@@ -44,6 +56,37 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace concol {
 
+#ifdef CONCOL_ALLOC_AUDIT
+namespace detail {
+
+// Allocation audit build (see concol_audit.h): every instrumented entry
+// point owns a counter, and the outermost scope on a thread is charged for
+// the heap allocations made until it ends.
+struct audit_entry;
+audit_entry& audit_register(const char* name) noexcept;
+
+class audit_scope final {
+  audit_entry* _previous;
+
+ public:
+  explicit audit_scope(audit_entry&) noexcept;
+  audit_scope(const audit_scope&) = delete;
+  audit_scope& operator=(const audit_scope&) = delete;
+  ~audit_scope();
+};
+
+}  // namespace detail
+
+#define CONCOL_AUDIT_SCOPE(name)                                   \
+  static ::concol::detail::audit_entry& concol_audit_entry_ =     \
+      ::concol::detail::audit_register(name);                     \
+  const ::concol::detail::audit_scope concol_audit_scope_ {       \
+    concol_audit_entry_                                           \
+  }
+#else
+#define CONCOL_AUDIT_SCOPE(name) static_cast<void>(0)
+#endif
+
 class ios_fmt_saver final {
   std::ios& iosref;
   std::ios ioscopy{NULL};
@@ -81,6 +124,51 @@ namespace detail {
 
 color_type to_bright(color_type _fg) noexcept;
 
+// Resolves the body of a tag (the text between the braces, without them).
+// An empty body is the reset tag and yields color_type::none.
+bool find_color_tag(const char* tag, std::size_t size, color_type& fg) noexcept;
+
+// Style of a named theme tag and its pre-rendered escape sequence.
+struct theme_style {
+  std::string name;
+  color_type fg;
+  color_type bg;
+  std::string escape;
+};
+
+// Looks the tag body up in the active theme; nullptr if it is not there.
+const theme_style* find_theme_tag(const char* tag, std::size_t size) noexcept;
+
+// Escape sequence of a builtin or theme tag, without allocating.
+bool find_tag_escape(const char* tag, std::size_t size, const char*& escape,
+                     std::size_t& escape_size) noexcept;
+
+std::string tagged_string(const char* tag, const char* str, std::size_t size);
+
+#ifndef CONCOL_NO_STRING_VIEW
+// Null-terminated copy of a view for the printf family, kept on the stack
+// for short format strings.
+class c_str_view final {
+  char _buffer[256];
+  std::string _string{};
+  const char* _c_str{_buffer};
+
+ public:
+  explicit c_str_view(const std::string_view& str) {
+    if (str.size() < sizeof(_buffer)) {
+      str.copy(_buffer, str.size());
+      _buffer[str.size()] = '\0';
+    } else {
+      _string.assign(str.data(), str.size());
+      _c_str = _string.c_str();
+    }
+  }
+  c_str_view(const c_str_view&) = delete;
+  c_str_view& operator=(const c_str_view&) = delete;
+  const char* c_str() const noexcept { return _c_str; }
+};
+#endif
+
 struct color_data {
   color_type fg_key;
   const char* const color;
@@ -100,6 +188,26 @@ struct color_constants {
   color_constants() = delete;
 };
 
+// Receives a copy of everything concol writes to its stream, e.g. the
+// flight_recorder from concol_recorder.h.
+class output_tee {
+ public:
+  virtual void write(const char* data, std::size_t size) noexcept = 0;
+
+ protected:
+  ~output_tee() = default;
+};
+
+// Takes the place of the stream as the destination of concol output, e.g.
+// the fd_sink from concol_sink.h. Every call carries one whole message.
+class output_sink {
+ public:
+  virtual void write(const char* data, std::size_t size) noexcept = 0;
+
+ protected:
+  ~output_sink() = default;
+};
+
 class color_base {
  protected:
   color_base() = default;
@@ -108,6 +216,34 @@ class color_base {
   static constexpr char _bright_tag{'+'};
   static bool _enabled;
   static std::FILE* _stream;
+  static std::atomic<output_tee*> _tee;
+  static std::atomic<output_sink*> _sink;
+
+  // write() with the sink and tee loaded once by the caller, so that one
+  // message never goes to two different targets.
+  static void write_to(output_sink* sink, output_tee* tee, const char* data,
+                       std::size_t size);
+
+#ifndef _WIN32
+  // printf into a buffer so that the tee and the sink get whole messages.
+  template <typename... Args>
+  static void tee_printf(output_sink* sink, output_tee* tee, const char* fmt,
+                         const Args&... args) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+    char buffer[512];
+    auto size = std::snprintf(buffer, sizeof(buffer), fmt, args...);
+    if (size < 0) return;
+    if (std::size_t(size) < sizeof(buffer)) {
+      write_to(sink, tee, buffer, std::size_t(size));
+      return;
+    }
+    std::string str(std::size_t(size) + 1, '\0');
+    std::snprintf(&str[0], str.size(), fmt, args...);
+    write_to(sink, tee, str.data(), std::size_t(size));
+#pragma GCC diagnostic pop
+  }
+#endif
 
 #ifdef _WIN32
   static void windows_printf(std::string&&);
@@ -128,8 +264,11 @@ class color_base {
   }
 #endif
   static std::string fmt_parse(const char*);
+  static std::string fmt_parse(const char*, std::size_t);
 
  public:
+  static void append_parsed(std::string& out, const char* fmt,
+                            std::size_t size);
   static std::string ansi_color_code(color_type,
                                      color_type _bg = color_type::none);
   static const char* ansi_color_reset() { return "\x1b[0m"; }
@@ -138,6 +277,24 @@ class color_base {
 #endif
   static void set_ostream(FILE* stream = stdout) noexcept { _stream = stream; }
   static decltype(_stream) get_ostream() noexcept { return _stream; }
+  // The tee and the sink are swapped atomically, but a writer may still be
+  // inside the previous one: destroy it only once concol output is quiet
+  // (the flight_recorder and the sinks unset themselves on destruction).
+  static void set_tee(output_tee* tee = nullptr) noexcept {
+    _tee.store(tee, std::memory_order_release);
+  }
+  static output_tee* get_tee() noexcept {
+    return _tee.load(std::memory_order_acquire);
+  }
+  // While a sink is set, output goes to it instead of the stream.
+  static void set_sink(output_sink* sink = nullptr) noexcept {
+    _sink.store(sink, std::memory_order_release);
+  }
+  static output_sink* get_sink() noexcept {
+    return _sink.load(std::memory_order_acquire);
+  }
+  // Writes rendered output to the sink or the stream, and to the tee.
+  static void write(const char* data, std::size_t size);
   static void set_enabled(bool enabled) noexcept { _enabled = enabled; }
   static bool is_enabled() noexcept { return _enabled; }
 };
@@ -173,6 +330,8 @@ struct color_tags {
 class color final : public detail::color_base {
   std::string _string{};
 
+  color& add_tagged(const char* tag, const char* str, std::size_t size);
+
  public:
   color() = default;
   color(const char*);
@@ -189,6 +348,9 @@ class color final : public detail::color_base {
   color operator+(color_ctrl);
   color operator+(const char*);
   color operator+(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color operator+(const std::string_view&);
+#endif
 
   friend color operator+(color_type lhs, const color& rhs) {
     color tmp{detail::color_tags::values[int(lhs)]};
@@ -221,60 +383,114 @@ class color final : public detail::color_base {
   color& operator+=(color_ctrl);
   color& operator+=(const char*);
   color& operator+=(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& operator+=(const std::string_view&);
+#endif
   void clear() noexcept { _string.clear(); }
   std::string to_string() const noexcept { return _string; }
   const char* c_str() const noexcept { return _string.c_str(); }
   color& add(const std::string&);
   color& add(const char*);
   color& add(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add(const std::string_view&);
+#endif
   color& add_black(const std::string&);
   color& add_black(const char*);
   color& add_black(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_black(const std::string_view&);
+#endif
   color& add_blue(const std::string&);
   color& add_blue(const char*);
   color& add_blue(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_blue(const std::string_view&);
+#endif
   color& add_green(const std::string&);
   color& add_green(const char*);
   color& add_green(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_green(const std::string_view&);
+#endif
   color& add_cyan(const std::string&);
   color& add_cyan(const char*);
   color& add_cyan(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_cyan(const std::string_view&);
+#endif
   color& add_red(const std::string&);
   color& add_red(const char*);
   color& add_red(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_red(const std::string_view&);
+#endif
   color& add_magenta(const std::string&);
   color& add_magenta(const char*);
   color& add_magenta(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_magenta(const std::string_view&);
+#endif
   color& add_yellow(const std::string&);
   color& add_yellow(const char*);
   color& add_yellow(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_yellow(const std::string_view&);
+#endif
   color& add_white(const std::string&);
   color& add_white(const char*);
   color& add_white(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_white(const std::string_view&);
+#endif
   color& add_black_bright(const std::string&);
   color& add_black_bright(const char*);
   color& add_black_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_black_bright(const std::string_view&);
+#endif
   color& add_blue_bright(const std::string&);
   color& add_blue_bright(const char*);
   color& add_blue_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_blue_bright(const std::string_view&);
+#endif
   color& add_green_bright(const std::string&);
   color& add_green_bright(const char*);
   color& add_green_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_green_bright(const std::string_view&);
+#endif
   color& add_cyan_bright(const std::string&);
   color& add_cyan_bright(const char*);
   color& add_cyan_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_cyan_bright(const std::string_view&);
+#endif
   color& add_red_bright(const std::string&);
   color& add_red_bright(const char*);
   color& add_red_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_red_bright(const std::string_view&);
+#endif
   color& add_magenta_bright(const std::string&);
   color& add_magenta_bright(const char*);
   color& add_magenta_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_magenta_bright(const std::string_view&);
+#endif
   color& add_yellow_bright(const std::string&);
   color& add_yellow_bright(const char*);
   color& add_yellow_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_yellow_bright(const std::string_view&);
+#endif
   color& add_white_bright(const std::string&);
   color& add_white_bright(const char*);
   color& add_white_bright(const char);
+#ifndef CONCOL_NO_STRING_VIEW
+  color& add_white_bright(const std::string_view&);
+#endif
   template <typename Type>
   color& add(const Type& value) {
     return add(std::to_string(value));
@@ -362,23 +578,67 @@ class color final : public detail::color_base {
   void print_white_bright() const;
   template <typename... Args>
   static void printf(const char* fmt, const Args&... args) {
+    CONCOL_AUDIT_SCOPE("color::printf");
 #ifndef _WIN32
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-security"
-    auto fmt_str = fmt_parse(fmt);
-    std::fprintf(_stream, fmt_str.c_str(), args...);
+    // Parsed into a per-thread buffer: no allocation once it has grown.
+    thread_local std::string fmt_str{};
+    fmt_str.clear();
+    append_parsed(fmt_str, fmt, std::strlen(fmt));
+    const auto sink = get_sink();
+    const auto tee = get_tee();
+    if (sink == nullptr && tee == nullptr) {
+      std::fprintf(_stream, fmt_str.c_str(), args...);
+    } else {
+      tee_printf(sink, tee, fmt_str.c_str(), args...);
+    }
 #pragma GCC diagnostic pop
 #else
     auto str = windows_to_string(fmt, args...);
+    const auto sink = get_sink();
+    const auto tee = get_tee();
+    if (sink != nullptr) {
+      // The sink gets the escape sequences; console attributes only apply
+      // to the stream.
+      auto sink_str = fmt_parse(str.c_str());
+      write_to(sink, tee, sink_str.data(), sink_str.size());
+      return;
+    }
+    if (tee != nullptr) {
+      auto tee_str = fmt_parse(str.c_str());
+      tee->write(tee_str.data(), tee_str.size());
+    }
     windows_printf(std::move(str));
 #endif
   }
   static void printf(const std::string& str) { printf(str.c_str()); }
 #ifndef CONCOL_NO_STRING_VIEW
-  static void printf(const std::string_view& str) { printf(str.data()); }
+  static void printf(const std::string_view& str) {
+    CONCOL_AUDIT_SCOPE("color::printf");
+#ifndef _WIN32
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+    thread_local std::string fmt_str{};
+    fmt_str.clear();
+    append_parsed(fmt_str, str.data(), str.size());
+    const auto sink = get_sink();
+    const auto tee = get_tee();
+    if (sink == nullptr && tee == nullptr) {
+      std::fprintf(_stream, fmt_str.c_str());
+    } else {
+      tee_printf(sink, tee, fmt_str.c_str());
+    }
+#pragma GCC diagnostic pop
+#else
+    detail::c_str_view fmt{str};
+    printf(fmt.c_str());
+#endif
+  }
 #endif
   template <typename... Args>
   static std::string to_string(const char* fmt, const Args&... args) {
+    CONCOL_AUDIT_SCOPE("color::to_string");
 #ifndef _WIN32
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-security"
@@ -404,7 +664,8 @@ class color final : public detail::color_base {
   template <typename... Args>
   static std::string to_string(const std::string_view& fmt_str,
                                const Args&... args) {
-    return to_string(fmt_str.data(), args...);
+    detail::c_str_view fmt{fmt_str};
+    return to_string(fmt.c_str(), args...);
   }
 #endif
 };
@@ -414,6 +675,21 @@ color to_color(Type value) {
   return color(std::to_string(value));
 }
 
+// Named styles for semantic tags such as {error} or {path}. A theme is
+// filled once and apply()-ed: its names are frozen into a perfect-hash table
+// that every tag parser consults after the builtin color names, so call
+// sites keep their tags when the theme changes.
+class theme final {
+  std::vector<detail::theme_style> _styles{};
+
+ public:
+  theme& set(const std::string& name, color_type fg,
+             color_type bg = color_type::none);
+  // Replaces the active theme; safe while other threads parse tags.
+  void apply() const;
+  static void clear();
+};
+
 }  // namespace concol
 
 template <typename charT, typename traits>
@@ -496,3 +772,7 @@ std::string operator""_yellow_bright(const char);
 std::string operator""_white_bright(const char);
 
 }  // namespace concol_literals
+
+#ifdef CONCOL_HEADER_ONLY
+#include "concol_inl.h"
+#endif
@@ -0,0 +1,55 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "concol.h"
+
+namespace concol {
+
+// Heap allocations charged to each instrumented concol entry point, counted
+// by the global operator new of a library built with CONCOL_ALLOC_AUDIT.
+// Nested entry points are charged to the outermost one on the thread.
+struct alloc_audit_entry {
+  const char* name;
+  std::uint64_t calls;
+  std::uint64_t allocations;
+  std::uint64_t bytes;
+};
+
+class alloc_audit final {
+ public:
+  static std::vector<alloc_audit_entry> snapshot();
+  // Counters of one entry point; all zero if it was never called.
+  static alloc_audit_entry find(const char* name) noexcept;
+  static void reset() noexcept;
+  static void report(std::FILE* stream = stderr);
+};
+
+}  // namespace concol
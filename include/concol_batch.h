@@ -0,0 +1,132 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "concol.h"
+
+namespace concol {
+
+// Fixed set of worker threads for render_batch(). Tasks of a run are claimed
+// from a shared atomic cursor, so a worker that finishes early keeps taking
+// what the slower ones have not reached yet.
+class batch_pool final {
+  using job_type = std::function<void(std::size_t task, std::size_t worker)>;
+
+  std::vector<std::thread> _threads{};
+  std::mutex _mutex{};
+  std::condition_variable _wake{};
+  std::condition_variable _done{};
+  const job_type* _job{};
+  std::size_t _tasks{};
+  std::atomic<std::size_t> _next{};
+  std::size_t _active{};
+  std::size_t _generation{};
+  bool _stop{};
+  std::exception_ptr _error{};
+
+  void work(std::size_t worker);
+
+ public:
+  explicit batch_pool(
+      std::size_t threads = std::thread::hardware_concurrency());
+  batch_pool(const batch_pool&) = delete;
+  batch_pool& operator=(const batch_pool&) = delete;
+  ~batch_pool();
+  // Number of workers, including the thread that calls run().
+  std::size_t size() const noexcept { return _threads.size() + 1; }
+  // Calls job(task, worker) for every task in [0, tasks) and returns when
+  // all of them are done; the first exception thrown is rethrown here.
+  void run(std::size_t tasks, const job_type& job);
+};
+
+namespace detail {
+
+using batch_renderer = std::function<void(std::size_t first, std::size_t last,
+                                          std::string& out,
+                                          std::string& scratch)>;
+
+void render_batch(std::size_t count, const batch_renderer& render,
+                  batch_pool& pool, std::FILE* stream);
+
+}  // namespace detail
+
+// Expands a batch of markup records in parallel and writes the results in
+// the original order, through color::write() (sink, stream and tee) unless
+// a `stream` is given. Memory stays bounded: records are rendered in
+// windows of a few chunks per worker.
+template <typename Iterator>
+void render_batch(Iterator first, Iterator last, batch_pool& pool,
+                  std::FILE* stream = nullptr) {
+  detail::render_batch(
+      std::size_t(std::distance(first, last)),
+      [first](std::size_t begin, std::size_t end, std::string& out,
+              std::string&) {
+        for (auto it = std::next(first, begin); begin != end; ++begin, ++it) {
+          const std::string_view record{*it};
+          color::append_parsed(out, record.data(), record.size());
+        }
+      },
+      pool, stream);
+}
+
+template <typename Range>
+void render_batch(const Range& records, batch_pool& pool,
+                  std::FILE* stream = nullptr) {
+  render_batch(std::begin(records), std::end(records), pool, stream);
+}
+
+// Same, with a formatter that turns one record into markup:
+// `void format(const Record&, std::string& markup)` appends to `markup`.
+template <typename Range, typename Formatter>
+void render_batch(const Range& records, Formatter format, batch_pool& pool,
+                  std::FILE* stream = nullptr) {
+  auto first = std::begin(records);
+  detail::render_batch(
+      std::size_t(std::distance(first, std::end(records))),
+      [first, &format](std::size_t begin, std::size_t end, std::string& out,
+                       std::string& scratch) {
+        for (auto it = std::next(first, begin); begin != end; ++begin, ++it) {
+          scratch.clear();
+          format(*it, scratch);
+          color::append_parsed(out, scratch.data(), scratch.size());
+        }
+      },
+      pool, stream);
+}
+
+}  // namespace concol
@@ -0,0 +1,207 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "concol.h"
+
+namespace concol {
+
+namespace detail {
+
+// Argument encoding of the binary log: 'i'/'l' signed 32/64-bit, 'u'/'U'
+// unsigned 32/64-bit, 'd' double, 'p' pointer and 's' length-prefixed bytes.
+template <typename T>
+constexpr char binlog_type() noexcept {
+  using type = std::decay_t<T>;
+  if constexpr (std::is_same_v<type, const char*> ||
+                std::is_same_v<type, char*> ||
+                std::is_same_v<type, std::string_view> ||
+                std::is_same_v<type, std::string>) {
+    return 's';
+  } else if constexpr (std::is_floating_point_v<type>) {
+    return 'd';
+  } else if constexpr (std::is_pointer_v<type>) {
+    return 'p';
+  } else {
+    static_assert(std::is_integral_v<type> || std::is_enum_v<type>,
+                  "unsupported binary log argument");
+    if constexpr (std::is_signed_v<type>) {
+      return sizeof(type) <= 4 ? 'i' : 'l';
+    } else {
+      return sizeof(type) <= 4 ? 'u' : 'U';
+    }
+  }
+}
+
+template <typename... Args>
+struct binlog_signature {
+  static constexpr char value[]{binlog_type<Args>()..., '\0'};
+};
+
+inline std::string_view binlog_string(std::string_view str) noexcept {
+  return str;
+}
+inline std::string_view binlog_string(const char* str) noexcept {
+  return str != nullptr ? std::string_view{str} : std::string_view{};
+}
+
+template <typename T>
+std::size_t binlog_size([[maybe_unused]] const T& arg) noexcept {
+  constexpr auto type = binlog_type<T>();
+  if constexpr (type == 's') {
+    return 4 + binlog_string(arg).size();
+  } else {
+    return (type == 'i' || type == 'u') ? 4 : 8;
+  }
+}
+
+template <typename T>
+void binlog_put(unsigned char*& out, const T& arg) noexcept {
+  constexpr auto type = binlog_type<T>();
+  if constexpr (type == 's') {
+    const auto str = binlog_string(arg);
+    const auto size = static_cast<std::uint32_t>(str.size());
+    std::memcpy(out, &size, 4);
+    std::memcpy(out + 4, str.data(), str.size());
+    out += 4 + str.size();
+  } else if constexpr (type == 'd') {
+    const auto value = static_cast<double>(arg);
+    std::memcpy(out, &value, 8);
+    out += 8;
+  } else if constexpr (type == 'p') {
+    const auto value = static_cast<std::uint64_t>(
+        reinterpret_cast<std::uintptr_t>(arg));
+    std::memcpy(out, &value, 8);
+    out += 8;
+  } else if constexpr (type == 'i') {
+    const auto value = static_cast<std::int32_t>(arg);
+    std::memcpy(out, &value, 4);
+    out += 4;
+  } else if constexpr (type == 'l') {
+    const auto value = static_cast<std::int64_t>(arg);
+    std::memcpy(out, &value, 8);
+    out += 8;
+  } else if constexpr (type == 'u') {
+    const auto value = static_cast<std::uint32_t>(arg);
+    std::memcpy(out, &value, 4);
+    out += 4;
+  } else {
+    const auto value = static_cast<std::uint64_t>(arg);
+    std::memcpy(out, &value, 8);
+    out += 8;
+  }
+}
+
+}  // namespace detail
+
+// Format id of one call site; ids are process wide, start at 1 and are
+// assigned on first use of the site.
+class binlog_format final {
+  static std::atomic<std::uint32_t> _next;
+
+ public:
+  const std::uint32_t id{_next.fetch_add(1, std::memory_order_relaxed)};
+};
+
+// Append-only binary log in a memory-mapped file (POSIX only). A message is
+// stored as its format id plus the raw argument bytes; the format string and
+// argument signature are written once per id as a definition record. The
+// file is expanded later by decode_binary_log() or the concol_binlog tool.
+// Records are reserved with one atomic add, so any number of threads may
+// write; messages that do not fit are dropped and counted.
+class binary_log final {
+  unsigned char* _data{};
+  std::size_t _capacity{};
+  std::atomic<std::size_t> _offset{};
+  std::atomic<std::uint64_t> _dropped{};
+  std::unique_ptr<std::atomic<std::uint64_t>[]> _defined{};
+  int _fd{-1};
+
+  unsigned char* reserve(std::size_t size) noexcept;
+  bool define(std::uint32_t id, const char* signature,
+              const char* fmt) noexcept;
+  static void commit(unsigned char* record, std::uint32_t id) noexcept;
+
+ public:
+  static constexpr std::size_t max_formats{1 << 14};
+  static constexpr std::size_t header_size{16};
+  static constexpr std::uint32_t define_flag{0x80000000};
+
+  binary_log(const std::string& path, std::size_t capacity);
+  binary_log(const binary_log&) = delete;
+  binary_log& operator=(const binary_log&) = delete;
+  // Unmaps the file and trims it to the written size.
+  ~binary_log();
+
+  template <typename... Args>
+  bool write(const binlog_format& site, const char* fmt,
+             const Args&... args) noexcept {
+    const auto id = site.id;
+    if (id >= max_formats) return false;
+    const std::uint64_t bit{std::uint64_t(1) << (id % 64)};
+    if ((_defined[id / 64].load(std::memory_order_acquire) & bit) == 0 &&
+        !define(id, detail::binlog_signature<Args...>::value, fmt)) {
+      return false;
+    }
+    const std::size_t size{(detail::binlog_size(args) + ... + 0)};
+    const auto record = reserve(size);
+    if (record == nullptr) return false;
+    [[maybe_unused]] auto out = record + 8;
+    (detail::binlog_put(out, args), ...);
+    commit(record, id);
+    return true;
+  }
+
+  // Schedules the written pages for writeback.
+  void flush() noexcept;
+  std::size_t size() const noexcept;
+  std::uint64_t dropped() const noexcept {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+};
+
+// Expands a binary log image through the concol tag engine: colored while
+// color::is_enabled(), plain text otherwise. Throws std::runtime_error when
+// the image has no binary log header.
+void decode_binary_log(const unsigned char* data, std::size_t size,
+                       std::string& out);
+
+}  // namespace concol
+
+#define CONCOL_BINLOG(log, ...)                                     \
+  do {                                                              \
+    static const ::concol::binlog_format concol_binlog_format_{};   \
+    (log).write(concol_binlog_format_, __VA_ARGS__);                \
+  } while (false)
@@ -0,0 +1,142 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+#include "concol.h"
+
+namespace concol {
+
+// Lazy color::printf. The calling thread only stores the format pointer and
+// a copy of the arguments in a bounded lock-free queue; tag expansion and
+// snprintf run on the consumer thread. While the consumer is not running
+// nothing is queued or formatted at all. Arguments end up in C varargs, so
+// only arithmetic, enum and pointer types compile: a class such as
+// std::string_view or a POD struct is rejected by a static_assert. Formats
+// and `const char*` arguments are kept by pointer and must outlive the
+// record, which string literals do.
+class deferred_printer final {
+ public:
+  static constexpr std::size_t max_args_size{64};
+
+ private:
+  using render_fn = void (*)(std::string&, const char*, const void*);
+
+  struct slot {
+    std::atomic<std::size_t> sequence;
+    render_fn render;
+    const char* fmt;
+    alignas(std::max_align_t) unsigned char args[max_args_size];
+  };
+
+  std::unique_ptr<slot[]> _slots{};
+  std::size_t _mask{};
+  alignas(64) std::atomic<std::size_t> _enqueue{};
+  // Producers between their _running check and publish; stop() waits for
+  // them so that no record is left behind.
+  std::atomic<std::size_t> _writers{};
+  alignas(64) std::size_t _dequeue{};
+  std::atomic<std::uint64_t> _dropped{};
+  std::atomic<bool> _running{};
+  std::thread _thread{};
+  std::string _out{};
+
+  slot* claim(std::size_t& pos) noexcept;
+  void publish(slot* s, std::size_t pos) noexcept {
+    s->sequence.store(pos + 1, std::memory_order_release);
+  }
+  static void append_format(std::string& out, const char* fmt, ...);
+
+  template <typename... Args>
+  static void render(std::string& out, const char* fmt, const void* data) {
+    const auto& args =
+        *std::launder(reinterpret_cast<const std::tuple<Args...>*>(data));
+    std::apply([&](const Args&... arg) { append_format(out, fmt, arg...); },
+               args);
+  }
+
+ public:
+  explicit deferred_printer(std::size_t capacity = 4096);
+  deferred_printer(const deferred_printer&) = delete;
+  deferred_printer& operator=(const deferred_printer&) = delete;
+  ~deferred_printer();
+
+  // Queues one message; false when the consumer is not running or the queue
+  // is full (the message is dropped and counted).
+  template <typename... Args>
+  bool printf(const char* fmt, Args... args) noexcept {
+    static_assert(((std::is_arithmetic_v<Args> || std::is_enum_v<Args> ||
+                    std::is_pointer_v<Args>) &&
+                   ...),
+                  "deferred arguments must be arithmetic, enum or pointer "
+                  "types");
+    static_assert(sizeof(std::tuple<Args...>) <= max_args_size,
+                  "deferred arguments are too large");
+    static_assert(alignof(std::tuple<Args...>) <= alignof(std::max_align_t));
+    CONCOL_AUDIT_SCOPE("deferred_printer::printf");
+    if (!_running.load(std::memory_order_relaxed)) return false;
+    _writers.fetch_add(1);
+    bool queued{};
+    std::size_t pos{};
+    if (_running.load()) {
+      if (auto s = claim(pos)) {
+        s->render = &render<Args...>;
+        s->fmt = fmt;
+        ::new (static_cast<void*>(s->args)) std::tuple<Args...>(args...);
+        publish(s, pos);
+        queued = true;
+      }
+    }
+    _writers.fetch_sub(1, std::memory_order_release);
+    return queued;
+  }
+
+  // Renders the published records, at most one ring's worth, and writes
+  // them with one color::write(); called by the consumer thread, or
+  // directly while it is stopped. Returns the number of records.
+  std::size_t drain();
+  // Starts the consumer thread; stop() joins it, waits for producers that
+  // are still queueing and drains what is left.
+  void start();
+  void stop();
+  bool running() const noexcept {
+    return _running.load(std::memory_order_relaxed);
+  }
+  std::uint64_t dropped() const noexcept {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace concol
@@ -0,0 +1,102 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "concol.h"
+
+namespace concol {
+
+// Argument of emergency_printf(): an integer, a string or a pointer, stored
+// by value so that nothing is allocated.
+class emergency_arg final {
+ public:
+  enum class kind { signed_value, unsigned_value, string, pointer };
+
+ private:
+  kind _kind;
+  union {
+    long long _signed;
+    unsigned long long _unsigned;
+    const char* _string;
+    const void* _pointer;
+  };
+
+ public:
+  emergency_arg(int value) noexcept
+      : _kind{kind::signed_value}, _signed{value} {}
+  emergency_arg(long value) noexcept
+      : _kind{kind::signed_value}, _signed{value} {}
+  emergency_arg(long long value) noexcept
+      : _kind{kind::signed_value}, _signed{value} {}
+  emergency_arg(unsigned value) noexcept
+      : _kind{kind::unsigned_value}, _unsigned{value} {}
+  emergency_arg(unsigned long value) noexcept
+      : _kind{kind::unsigned_value}, _unsigned{value} {}
+  emergency_arg(unsigned long long value) noexcept
+      : _kind{kind::unsigned_value}, _unsigned{value} {}
+  emergency_arg(const char* value) noexcept
+      : _kind{kind::string}, _string{value} {}
+  emergency_arg(const void* value) noexcept
+      : _kind{kind::pointer}, _pointer{value} {}
+
+  kind type() const noexcept { return _kind; }
+  long long as_signed() const noexcept {
+    return (_kind == kind::signed_value) ? _signed
+                                         : static_cast<long long>(_unsigned);
+  }
+  unsigned long long as_unsigned() const noexcept {
+    switch (_kind) {
+      case kind::signed_value:
+        return static_cast<unsigned long long>(_signed);
+      case kind::pointer:
+        return reinterpret_cast<std::uintptr_t>(_pointer);
+      default:
+        return _unsigned;
+    }
+  }
+  const char* as_string() const noexcept {
+    return (_kind == kind::string) ? _string : nullptr;
+  }
+};
+
+// Async-signal-safe printf for crash and signal handlers: tags come from the
+// static escape table (and the active theme), the output is built in a
+// fixed stack buffer and written to `fd` with write(2). No allocation, no
+// lock, no stdio. Supports %d %i %u %x %X %c %s %p and %% with an optional
+// '-' or '0' flag and a width; length modifiers are accepted and ignored.
+void emergency_print(int fd, const char* fmt, const emergency_arg* args,
+                     std::size_t count) noexcept;
+
+template <typename... Args>
+void emergency_printf(int fd, const char* fmt, const Args&... args) noexcept {
+  const emergency_arg values[sizeof...(Args) + 1]{args..., 0};
+  emergency_print(fd, fmt, values, sizeof...(Args));
+}
+
+}  // namespace concol
@@ -0,0 +1,102 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "concol.h"
+
+namespace concol {
+
+enum class byte_class : unsigned char { zero, printable, control, high };
+
+// Tags (builtin colors or theme names) for each byte class; an empty tag
+// leaves the class unstyled.
+struct hexdump_styles {
+  std::string zero{"{+black}"};
+  std::string printable{"{cyan}"};
+  std::string control{"{green}"};
+  std::string high{"{yellow}"};
+};
+
+// Renders bytes in the `hexdump -C` layout, 16 per line; a short last line
+// keeps the character column aligned:
+//
+//   00000010  48 69 21 0a                                       |Hi!.|
+//
+// Bytes are colored by class, looked up in a 256-entry table, in both the
+// hex and the character column; an escape is written only where the class
+// changes. Hex digits come from a SIMD nibble shuffle, 16 bytes at a time.
+// Output equals `hexdump -Cv` (without the closing offset line) when
+// colors are disabled: repeated lines are not folded into `*`.
+class hexdump_renderer final {
+  static constexpr std::size_t class_count{4};
+  // Style index shared by all classes without an escape.
+  static constexpr unsigned char plain{class_count};
+  static constexpr std::size_t slot_size{16};
+  // Lines rendered into the scratch buffer before it is appended.
+  static constexpr std::size_t block_lines{256};
+
+  // What starts each style: the escape of a class, or a reset for plain.
+  // Padded to slot_size, so that the hot loop stores a whole slot for
+  // every byte and only advances past it where the style changes.
+  std::string _transitions[class_count + 1]{};
+  std::size_t _transition_sizes[class_count + 1]{};
+  unsigned char _classes[256]{};
+  unsigned char _styles[256]{};
+  std::size_t _line_size{};
+  std::unique_ptr<char[]> _scratch{};
+
+  char* transition(char* out, unsigned char style,
+                   bool change) const noexcept;
+  char* render_line(const unsigned char* data, std::size_t size,
+                    std::uint64_t offset, unsigned offset_digits,
+                    char* out) const noexcept;
+
+ public:
+  static constexpr std::size_t bytes_per_line{16};
+
+  explicit hexdump_renderer(const hexdump_styles& styles = hexdump_styles{});
+  // Moves one byte value to another class, e.g. '\n' to printable.
+  void set_class(unsigned char byte, byte_class cls) noexcept;
+  byte_class class_of(unsigned char byte) const noexcept {
+    return static_cast<byte_class>(_classes[byte]);
+  }
+  // Appends the lines of [data, data + size) to `out`; offsets start at
+  // `offset` and use 16 digits once they no longer fit in 8.
+  void render(const void* data, std::size_t size, std::string& out,
+              std::uint64_t offset = 0);
+};
+
+// Renders with the default styles and writes through color::write(), 64 KB
+// of input at a time.
+void print_hexdump(const void* data, std::size_t size,
+                   std::uint64_t offset = 0);
+
+}  // namespace concol
@@ -0,0 +1,162 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "concol.h"
+
+namespace concol {
+
+enum class highlight_format : int { automatic, json, logfmt };
+
+// Tags (builtin colors or theme names) for each kind of token; an empty
+// tag leaves the token unstyled.
+struct highlight_styles {
+  std::string key{"{cyan}"};
+  std::string string{"{green}"};
+  std::string number{"{yellow}"};
+  std::string literal{"{magenta}"};
+  std::string error{"{+red}"};
+  std::string warning{"{+yellow}"};
+  std::string info{"{+green}"};
+  std::string debug{"{+black}"};
+};
+
+// Streaming syntax highlighter for JSON lines and logfmt. A lexer state
+// machine styles keys, strings, numbers, true/false/null and the values of
+// level keys ("level", "lvl", "severity"), without building a tree and
+// across chunk boundaries. String bodies and bare words are skipped with a
+// SIMD scan for their few structural bytes. With the automatic format,
+// lines starting with '{' or '[' are JSON and all others logfmt. Output
+// equals input when colors are disabled.
+class structured_highlighter final {
+  enum class state : int {
+    line_start,
+    json,
+    json_bare,
+    string,
+    logfmt,
+    logfmt_value,
+    plain_word,
+    deferred
+  };
+  // Tokens whose style depends on their whole text: logfmt words (key or
+  // plain), logfmt bare values, and JSON values of level keys.
+  enum class token : int { word, bare, json_bare, quoted };
+  enum style : int {
+    none,
+    key,
+    string,
+    number,
+    literal,
+    error,
+    warning,
+    info,
+    debug,
+    style_count
+  };
+
+  highlight_format _format{};
+  std::string _escapes[style_count]{};
+  std::size_t _max_escape{};
+  state _state{state::line_start};
+  // Where a string or deferred token continues: state::json or logfmt.
+  state _after{state::json};
+  token _token{};
+  // Open JSON containers, one bit per level (1 for objects).
+  std::uint64_t _containers{};
+  unsigned _depth{};
+  bool _expect_key{};
+  bool _is_key{};
+  bool _escaped{};
+  bool _level_key{};
+  bool _styled{};
+  // A deferred token cut by the end of a chunk.
+  std::string _pending{};
+  std::string _key{};
+  // Output of one feed: sized for the worst case, so that tokens are
+  // written with plain stores and copied to the caller's string once.
+  std::unique_ptr<char[]> _scratch{};
+  std::size_t _scratch_size{};
+  char* _out{};
+
+  static style bare_style(std::string_view token) noexcept;
+  static style level_style(std::string_view value, style fallback) noexcept;
+  static style first_style(char ch) noexcept;
+  style token_style(std::string_view text) const noexcept;
+
+  void reserve(std::size_t input_size);
+  void put(char ch) noexcept { *_out++ = ch; }
+  void put(const char* pos, std::size_t size) noexcept {
+    std::memcpy(_out, pos, size);
+    _out += size;
+  }
+  void open(style s) noexcept;
+  void close() noexcept;
+  void end_line() noexcept;
+  bool in_object() const noexcept;
+
+  const char* token_end(const char* pos, const char* end) noexcept;
+  const char* start_token(token kind, const char* pos, const char* end);
+  const char* emit_token(const char* pos, const char* stop, const char* term);
+  void overflow();
+
+  const char* line_start(const char* pos, const char* end) noexcept;
+  const char* json(const char* pos, const char* end);
+  const char* json_bare(const char* pos, const char* end) noexcept;
+  const char* quoted(const char* pos, const char* end);
+  const char* logfmt(const char* pos, const char* end);
+  const char* logfmt_value(const char* pos, const char* end);
+  const char* plain_word(const char* pos, const char* end) noexcept;
+  const char* deferred(const char* pos, const char* end);
+
+ public:
+  // Longest token held back across chunks; longer ones are written with
+  // their fallback style as they come.
+  static constexpr std::size_t max_pending{256};
+
+  explicit structured_highlighter(
+      highlight_format format = highlight_format::automatic,
+      const highlight_styles& styles = highlight_styles{});
+  // Appends the highlighted `chunk` to `out`.
+  void feed(std::string_view chunk, std::string& out);
+  // Writes a held back token and closes an open style.
+  void finish(std::string& out);
+};
+
+// Highlights a whole stream 64 KB at a time, flushing after every chunk so
+// that it can follow `tail -f`.
+void highlight_stream(std::FILE* in, std::FILE* out,
+                      highlight_format format = highlight_format::automatic);
+
+}  // namespace concol
@@ -0,0 +1,84 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "concol.h"
+#include "concol_text.h"
+
+namespace concol {
+
+// Converts concol markup or ANSI SGR output to HTML. Text is escaped in
+// runs, styles become <span> elements with the CSS classes of stylesheet(),
+// and adjacent text with the same style shares one span. Input is fed in
+// chunks of any size; only an escape sequence or tag cut by a chunk
+// boundary is carried over, so memory stays bounded for any input size.
+class html_converter final {
+  struct style {
+    signed char fg{-1};
+    signed char bg{-1};
+    bool bold{};
+    bool operator==(const style& rhs) const noexcept {
+      return fg == rhs.fg && bg == rhs.bg && bold == rhs.bold;
+    }
+    bool operator!=(const style& rhs) const noexcept {
+      return !(*this == rhs);
+    }
+  };
+
+  text_format _format{};
+  style _current{};
+  style _open{};
+  std::string _pending{};
+
+  std::size_t sequence_size(const char* pos, const char* end) const noexcept;
+  void apply(const char* pos, std::size_t size, std::string& out);
+  void apply_sgr(const char* pos, const char* end) noexcept;
+  void append_text(const char* pos, const char* end, std::string& out);
+  void close_span(std::string& out);
+
+ public:
+  static constexpr std::size_t max_pending{256};
+
+  explicit html_converter(text_format format = text_format::ansi) noexcept
+      : _format{format} {}
+  // Appends the HTML of `chunk` to `out`.
+  void feed(std::string_view chunk, std::string& out);
+  // Flushes an unfinished tag as text and closes the open span.
+  void finish(std::string& out);
+  // CSS for the classes used in the spans.
+  static const char* stylesheet() noexcept;
+};
+
+// Converts a whole stream into a standalone HTML document, 64 KB at a time.
+void write_html(std::FILE* in, std::FILE* out,
+                text_format format = text_format::ansi);
+
+}  // namespace concol
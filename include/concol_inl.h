@@ -0,0 +1,1204 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "concol.h"
+
+namespace concol {
+namespace detail {
+
+CONCOL_INLINE bool color_base::_enabled{false};
+CONCOL_INLINE std::FILE* color_base::_stream{stdout};
+CONCOL_INLINE std::atomic<output_tee*> color_base::_tee{};
+CONCOL_INLINE std::atomic<output_sink*> color_base::_sink{};
+
+#if __cplusplus < 201703L
+constexpr color_data color_constants::values[];
+constexpr const char* const color_tags::values[];
+#endif
+
+CONCOL_INLINE color_type to_bright(color_type _fg) noexcept {
+  return color_type(int(_fg) + int(color_type::black_bright));
+}
+
+// Builtin names are told apart by their length and first character, so at
+// most one comparison is made per tag.
+CONCOL_INLINE bool find_color_tag(const char* tag, std::size_t size,
+                                  color_type& fg) noexcept {
+  if (size == 0) {
+    fg = color_type::none;
+    return true;
+  }
+  bool bright{};
+  if (*tag == '+') {
+    bright = true;
+    tag += 1;
+    size -= 1;
+  }
+  int index{};
+  switch (size) {
+    case 3:
+      index = 1;  // red
+      break;
+    case 4:
+      index = (*tag == 'b') ? 4 : 6;  // blue, cyan
+      break;
+    case 5:
+      index = (*tag == 'b') ? 0 : (*tag == 'g') ? 2 : 7;  // black, green, white
+      break;
+    case 6:
+      index = 3;  // yellow
+      break;
+    case 7:
+      index = 5;  // magenta
+      break;
+    default:
+      return false;
+  }
+  const auto& val = color_constants::values[index];
+  if (std::memcmp(tag, val.color, size) != 0) return false;
+  fg = (bright) ? to_bright(val.fg_key) : val.fg_key;
+  return true;
+}
+
+// Frozen theme: names are placed by a seeded FNV-1a hash, with the seed
+// searched at build time until no two names share a slot.
+class theme_table final {
+  std::vector<theme_style> _styles{};
+  std::vector<std::int32_t> _slots{};
+  std::uint32_t _seed{};
+  std::uint32_t _mask{};
+
+  static std::uint32_t hash(const char* str, std::size_t size,
+                            std::uint32_t seed) noexcept {
+    std::uint32_t value{2166136261u ^ seed};
+    for (std::size_t i = 0; i < size; ++i) {
+      value = (value ^ static_cast<unsigned char>(str[i])) * 16777619u;
+    }
+    return value ^ (value >> 15);
+  }
+
+ public:
+  explicit theme_table(std::vector<theme_style> styles)
+      : _styles{std::move(styles)} {
+    std::size_t size{2};
+    while (size < _styles.size() * 2) size <<= 1;
+    for (;; size <<= 1) {
+      _mask = std::uint32_t(size - 1);
+      for (_seed = 0; _seed < 256; ++_seed) {
+        _slots.assign(size, -1);
+        bool collision{};
+        for (std::size_t i = 0; i < _styles.size() && !collision; ++i) {
+          const auto& name = _styles[i].name;
+          auto& slot = _slots[hash(name.data(), name.size(), _seed) & _mask];
+          collision = slot != -1;
+          slot = std::int32_t(i);
+        }
+        if (!collision) return;
+      }
+    }
+  }
+  const theme_style* find(const char* tag, std::size_t size) const noexcept {
+    const auto slot = _slots[hash(tag, size, _seed) & _mask];
+    if (slot < 0) return nullptr;
+    const auto& style = _styles[std::size_t(slot)];
+    if (style.name.size() != size ||
+        std::memcmp(style.name.data(), tag, size) != 0) {
+      return nullptr;
+    }
+    return &style;
+  }
+  static std::atomic<const theme_table*>& active() noexcept {
+    static std::atomic<const theme_table*> table{};
+    return table;
+  }
+  // Replaced tables stay alive: a parser on another thread may still be
+  // reading one.
+  static void install(std::unique_ptr<theme_table> table) {
+    static std::mutex mutex{};
+    static std::vector<std::unique_ptr<theme_table>> tables{};
+    std::lock_guard<std::mutex> lock{mutex};
+    active().store(table.get(), std::memory_order_release);
+    tables.push_back(std::move(table));
+  }
+};
+
+CONCOL_INLINE const theme_style* find_theme_tag(const char* tag,
+                                                std::size_t size) noexcept {
+  const auto table = theme_table::active().load(std::memory_order_acquire);
+  return (table != nullptr) ? table->find(tag, size) : nullptr;
+}
+
+CONCOL_INLINE bool find_tag_escape(const char* tag, std::size_t size,
+                                   const char*& escape,
+                                   std::size_t& escape_size) noexcept {
+  static constexpr const char* const escapes[]{
+      "\x1b[0m",      "\x1b[0;30m",   "\x1b[0;34m",   "\x1b[0;32m",
+      "\x1b[0;36m",   "\x1b[0;31m",   "\x1b[0;35m",   "\x1b[0;33m",
+      "\x1b[0;37m",   "\x1b[0;30;1m", "\x1b[0;34;1m", "\x1b[0;32;1m",
+      "\x1b[0;36;1m", "\x1b[0;31;1m", "\x1b[0;35;1m", "\x1b[0;33;1m",
+      "\x1b[0;37;1m"};
+  color_type fg{};
+  if (find_color_tag(tag, size, fg)) {
+    escape = escapes[int(fg) + 1];
+    escape_size = 9;
+    if (fg == color_type::none) {
+      escape_size = 4;
+    } else if (int(fg) < int(color_type::black_bright)) {
+      escape_size = 7;
+    }
+    return true;
+  }
+  if (const auto style = find_theme_tag(tag, size)) {
+    escape = style->escape.data();
+    escape_size = style->escape.size();
+    return true;
+  }
+  return false;
+}
+
+CONCOL_INLINE std::string tagged_string(const char* tag, const char* str,
+                                        std::size_t size) {
+  CONCOL_AUDIT_SCOPE("concol_literals");
+  const auto tag_size = std::strlen(tag);
+  const auto reset_size = std::strlen(color_tags::reset);
+  std::string tmp{};
+  tmp.reserve(tag_size + size + reset_size);
+  tmp.append(tag, tag_size);
+  tmp.append(str, size);
+  tmp.append(color_tags::reset, reset_size);
+  return tmp;
+}
+
+CONCOL_INLINE std::string color_base::ansi_color_code(color_type _fg,
+                                                      color_type _bg) {
+  CONCOL_AUDIT_SCOPE("color::ansi_color_code");
+  const int _color[]{0, 4, 2, 6, 1, 5, 3, 7};
+  std::string str{"\x1b[0;"};
+  if (_fg != color_type::none) {
+    str += std::to_string(30 + _color[(int(_fg) & int(color_type::white))]);
+    if (int(_fg) > int(color_type::white)) {
+      str += ";1";
+    }
+  }
+  if (_bg != color_type::none) {
+    str +=
+        ';' + std::to_string(40 + _color[(int(_bg) & int(color_type::white))]);
+  }
+  return std::string{str + 'm'};
+}
+
+#ifdef _WIN32
+
+CONCOL_INLINE void color_base::windows_set_color(color_type _fg,
+                                                 color_type _bg) {
+  auto handle = GetStdHandle(STD_OUTPUT_HANDLE);
+  if (handle != nullptr) {
+    CONSOLE_SCREEN_BUFFER_INFO info{};
+    auto status = GetConsoleScreenBufferInfo(handle, &info);
+    if (status) {
+      WORD color = info.wAttributes;
+      if (_fg != color_type::none) {
+        color = (color & 0xFFF0) | int(_fg);
+      }
+      if (_bg != color_type::none) {
+        color = (color & 0xFF0F) | int(_bg) << 4;
+      }
+      SetConsoleTextAttribute(handle, color);
+    }
+  }
+}
+
+CONCOL_INLINE void color_base::windows_printf(std::string&& str) {
+  for (;;) {
+    auto start_pos = str.find_first_of(_open_tag);
+    auto stop_pos = str.find_first_of(_close_tag, start_pos + 1);
+    if (start_pos == std::string::npos || stop_pos == std::string::npos) {
+      std::fprintf(_stream, str.c_str());
+      break;
+    }
+    if (start_pos != 0) {
+      std::fprintf(_stream, str.substr(0, start_pos).c_str());
+      str.erase(0, start_pos);
+      continue;
+    }
+    if (stop_pos - start_pos == 1) {
+      if (_enabled) {
+        color_base::windows_set_color(color_type::white, color_type::black);
+      }
+      str.erase(0, stop_pos - start_pos + 1);
+    } else {
+      const char* tag{str.c_str() + 1};
+      const size_t tag_size{stop_pos - start_pos - 1};
+      color_type fg_key{};
+      color_type bg_key{color_type::none};
+      bool isColorKey{find_color_tag(tag, tag_size, fg_key)};
+      if (!isColorKey) {
+        if (const auto style = find_theme_tag(tag, tag_size)) {
+          isColorKey = true;
+          fg_key = style->fg;
+          bg_key = style->bg;
+        }
+      }
+      if (!isColorKey) {
+        std::fprintf(_stream, str.substr(0, stop_pos - start_pos + 1).c_str());
+      } else if (_enabled) {
+        color_base::windows_set_color(fg_key, bg_key);
+      }
+      str.erase(0, stop_pos - start_pos + 1);
+    }
+  }
+}
+
+#endif
+
+CONCOL_INLINE void color_base::append_parsed(std::string& out, const char* fmt,
+                                             std::size_t size) {
+  CONCOL_AUDIT_SCOPE("color::append_parsed");
+  const char* pos{fmt};
+  const char* const end{fmt + size};
+  while (pos != end) {
+    auto start = static_cast<const char*>(
+        std::memchr(pos, _open_tag, std::size_t(end - pos)));
+    if (start == nullptr) break;
+    auto stop = static_cast<const char*>(
+        std::memchr(start + 1, _close_tag, std::size_t(end - start - 1)));
+    if (stop == nullptr) break;
+    out.append(pos, start);
+    pos = stop + 1;
+    const char* escape{};
+    std::size_t escape_size{};
+    if (!find_tag_escape(start + 1, std::size_t(stop - start - 1), escape,
+                         escape_size)) {
+      out.append(start, pos);
+      continue;
+    }
+    if (_enabled) {
+      out.append(escape, escape_size);
+    }
+  }
+  out.append(pos, end);
+}
+
+CONCOL_INLINE void color_base::write(const char* data, std::size_t size) {
+  write_to(get_sink(), get_tee(), data, size);
+}
+
+CONCOL_INLINE void color_base::write_to(output_sink* sink, output_tee* tee,
+                                        const char* data, std::size_t size) {
+  if (sink != nullptr) {
+    sink->write(data, size);
+  } else {
+    std::fwrite(data, 1, size, _stream);
+  }
+  if (tee != nullptr) {
+    tee->write(data, size);
+  }
+}
+
+CONCOL_INLINE std::string color_base::fmt_parse(const char* fmt,
+                                                std::size_t size) {
+  std::string fmt_str{};
+  fmt_str.reserve(size);
+  append_parsed(fmt_str, fmt, size);
+  return fmt_str;
+}
+
+CONCOL_INLINE std::string color_base::fmt_parse(const char* fmt) {
+  return fmt_parse(fmt, std::strlen(fmt));
+}
+
+}  // namespace detail
+
+CONCOL_INLINE color::color(const char* c_str) : _string{c_str} {}
+
+CONCOL_INLINE color::color(const std::string& str) : _string{str} {}
+
+CONCOL_INLINE color::color(std::string&& str) : _string{std::move(str)} {}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color::color(const std::string_view& str)
+    : _string{str.data(), str.size()} {}
+#endif
+
+CONCOL_INLINE color& color::add_tagged(const char* tag, const char* str,
+                                       std::size_t size) {
+  CONCOL_AUDIT_SCOPE("color::add_*");
+  const auto tag_size = std::strlen(tag);
+  const auto reset_size = std::strlen(detail::color_tags::reset);
+  _string.append(tag, tag_size);
+  _string.append(str, size);
+  _string.append(detail::color_tags::reset, reset_size);
+  return *this;
+}
+
+CONCOL_INLINE color color::operator+(color_type rhs) {
+  color tmp{*this};
+  tmp._string += detail::color_tags::values[int(rhs)];
+  return tmp;
+}
+
+CONCOL_INLINE color color::operator+(color_ctrl rhs) {
+  color tmp{*this};
+  tmp._string += detail::color_tags::values[int(rhs)];
+  return tmp;
+}
+
+CONCOL_INLINE color color::operator+(const color& rhs) {
+  color tmp{*this};
+  tmp._string += rhs._string;
+  return tmp;
+}
+
+CONCOL_INLINE color color::operator+(const std::string& rhs) {
+  color tmp{*this};
+  tmp._string += rhs;
+  return tmp;
+}
+
+CONCOL_INLINE color color::operator+(const char* rhs) {
+  color tmp{*this};
+  tmp._string += rhs;
+  return tmp;
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color color::operator+(const std::string_view& rhs) {
+  color tmp{*this};
+  tmp._string.append(rhs.data(), rhs.size());
+  return tmp;
+}
+#endif
+
+CONCOL_INLINE color color::operator+(const char rhs) {
+  color tmp{*this};
+  tmp._string += rhs;
+  return tmp;
+}
+
+CONCOL_INLINE color& color::operator+=(const color& rhs) {
+  _string += rhs._string;
+  return *this;
+}
+
+CONCOL_INLINE color& color::operator+=(const std::string& rhs) {
+  _string += rhs;
+  return *this;
+}
+
+CONCOL_INLINE color& color::operator+=(color_type rhs) {
+  _string += detail::color_tags::values[int(rhs)];
+  return *this;
+}
+
+CONCOL_INLINE color& color::operator+=(color_ctrl rhs) {
+  _string += detail::color_tags::values[int(rhs)];
+  return *this;
+}
+
+CONCOL_INLINE color& color::operator+=(const char* rhs) {
+  _string += rhs;
+  return *this;
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::operator+=(const std::string_view& rhs) {
+  _string.append(rhs.data(), rhs.size());
+  return *this;
+}
+#endif
+
+CONCOL_INLINE color& color::operator+=(const char rhs) {
+  _string += rhs;
+  return *this;
+}
+
+CONCOL_INLINE void color::print() const { printf(_string); }
+
+CONCOL_INLINE void color::print_black() const {
+  printf(detail::tagged_string(detail::color_tags::black, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_blue() const {
+  printf(detail::tagged_string(detail::color_tags::blue, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_green() const {
+  printf(detail::tagged_string(detail::color_tags::green, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_cyan() const {
+  printf(detail::tagged_string(detail::color_tags::cyan, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_red() const {
+  printf(detail::tagged_string(detail::color_tags::red, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_magenta() const {
+  printf(detail::tagged_string(detail::color_tags::magenta, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_yellow() const {
+  printf(detail::tagged_string(detail::color_tags::yellow, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_white() const {
+  printf(detail::tagged_string(detail::color_tags::white, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_black_bright() const {
+  printf(detail::tagged_string(detail::color_tags::black_bright, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_blue_bright() const {
+  printf(detail::tagged_string(detail::color_tags::blue_bright, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_green_bright() const {
+  printf(detail::tagged_string(detail::color_tags::green_bright, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_cyan_bright() const {
+  printf(detail::tagged_string(detail::color_tags::cyan_bright, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_red_bright() const {
+  printf(detail::tagged_string(detail::color_tags::red_bright, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE void color::print_magenta_bright() const {
+  printf(detail::tagged_string(detail::color_tags::magenta_bright,
+                               _string.data(), _string.size()));
+}
+
+CONCOL_INLINE void color::print_yellow_bright() const {
+  printf(detail::tagged_string(detail::color_tags::yellow_bright,
+                               _string.data(), _string.size()));
+}
+
+CONCOL_INLINE void color::print_white_bright() const {
+  printf(detail::tagged_string(detail::color_tags::white_bright, _string.data(),
+                               _string.size()));
+}
+
+CONCOL_INLINE color& color::add(const std::string& str) {
+  _string += str;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add(const char* c_str) {
+  _string += c_str;
+  return *this;
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add(const std::string_view& str) {
+  _string.append(str.data(), str.size());
+  return *this;
+}
+#endif
+
+CONCOL_INLINE color& color::add(const char ch) {
+  _string += ch;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_black(const std::string& str) {
+  return add_tagged(detail::color_tags::black, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_black(const char* c_str) {
+  return add_tagged(detail::color_tags::black, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_black(const std::string_view& str) {
+  return add_tagged(detail::color_tags::black, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_black(const char ch) {
+  _string += detail::color_tags::black;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_blue(const std::string& str) {
+  return add_tagged(detail::color_tags::blue, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_blue(const char* c_str) {
+  return add_tagged(detail::color_tags::blue, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_blue(const std::string_view& str) {
+  return add_tagged(detail::color_tags::blue, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_blue(const char ch) {
+  _string += detail::color_tags::blue;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_green(const std::string& str) {
+  return add_tagged(detail::color_tags::green, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_green(const char* c_str) {
+  return add_tagged(detail::color_tags::green, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_green(const std::string_view& str) {
+  return add_tagged(detail::color_tags::green, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_green(const char ch) {
+  _string += detail::color_tags::green;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_cyan(const std::string& str) {
+  return add_tagged(detail::color_tags::cyan, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_cyan(const char* c_str) {
+  return add_tagged(detail::color_tags::cyan, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_cyan(const std::string_view& str) {
+  return add_tagged(detail::color_tags::cyan, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_cyan(const char ch) {
+  _string += detail::color_tags::cyan;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_red(const std::string& str) {
+  return add_tagged(detail::color_tags::red, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_red(const char* c_str) {
+  return add_tagged(detail::color_tags::red, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_red(const std::string_view& str) {
+  return add_tagged(detail::color_tags::red, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_red(const char ch) {
+  _string += detail::color_tags::red;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_magenta(const std::string& str) {
+  return add_tagged(detail::color_tags::magenta, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_magenta(const char* c_str) {
+  return add_tagged(detail::color_tags::magenta, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_magenta(const std::string_view& str) {
+  return add_tagged(detail::color_tags::magenta, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_magenta(const char ch) {
+  _string += detail::color_tags::magenta;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_yellow(const std::string& str) {
+  return add_tagged(detail::color_tags::yellow, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_yellow(const char* c_str) {
+  return add_tagged(detail::color_tags::yellow, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_yellow(const std::string_view& str) {
+  return add_tagged(detail::color_tags::yellow, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_yellow(const char ch) {
+  _string += detail::color_tags::yellow;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_white(const std::string& str) {
+  return add_tagged(detail::color_tags::white, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_white(const char* c_str) {
+  return add_tagged(detail::color_tags::white, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_white(const std::string_view& str) {
+  return add_tagged(detail::color_tags::white, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_white(const char ch) {
+  _string += detail::color_tags::white;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_black_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::black_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_black_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::black_bright, c_str,
+                    std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_black_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::black_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_black_bright(const char ch) {
+  _string += detail::color_tags::black_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_blue_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::blue_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_blue_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::blue_bright, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_blue_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::blue_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_blue_bright(const char ch) {
+  _string += detail::color_tags::blue_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_green_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::green_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_green_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::green_bright, c_str,
+                    std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_green_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::green_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_green_bright(const char ch) {
+  _string += detail::color_tags::green_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+CONCOL_INLINE color& color::add_cyan_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::cyan_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_cyan_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::cyan_bright, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_cyan_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::cyan_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_cyan_bright(const char ch) {
+  _string += detail::color_tags::cyan_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_red_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::red_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_red_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::red_bright, c_str, std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_red_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::red_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_red_bright(const char ch) {
+  _string += detail::color_tags::red_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_magenta_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::magenta_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_magenta_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::magenta_bright, c_str,
+                    std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_magenta_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::magenta_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_magenta_bright(const char ch) {
+  _string += detail::color_tags::magenta_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_yellow_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::yellow_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_yellow_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::yellow_bright, c_str,
+                    std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_yellow_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::yellow_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_yellow_bright(const char ch) {
+  _string += detail::color_tags::yellow_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE color& color::add_white_bright(const std::string& str) {
+  return add_tagged(detail::color_tags::white_bright, str.data(), str.size());
+}
+
+CONCOL_INLINE color& color::add_white_bright(const char* c_str) {
+  return add_tagged(detail::color_tags::white_bright, c_str,
+                    std::strlen(c_str));
+}
+
+#ifndef CONCOL_NO_STRING_VIEW
+CONCOL_INLINE color& color::add_white_bright(const std::string_view& str) {
+  return add_tagged(detail::color_tags::white_bright, str.data(), str.size());
+}
+#endif
+
+CONCOL_INLINE color& color::add_white_bright(const char ch) {
+  _string += detail::color_tags::white_bright;
+  _string += ch;
+  _string += detail::color_tags::reset;
+  return *this;
+}
+
+CONCOL_INLINE theme& theme::set(const std::string& name, color_type fg,
+                                color_type bg) {
+  if (name.empty() || name[0] == '+') {
+    throw std::invalid_argument("theme: invalid tag name");
+  }
+  detail::theme_style style{name, fg, bg, color::ansi_color_code(fg, bg)};
+  for (auto& val : _styles) {
+    if (val.name == name) {
+      val = std::move(style);
+      return *this;
+    }
+  }
+  _styles.push_back(std::move(style));
+  return *this;
+}
+
+CONCOL_INLINE void theme::apply() const {
+  detail::theme_table::install(std::make_unique<detail::theme_table>(_styles));
+}
+
+CONCOL_INLINE void theme::clear() {
+  detail::theme_table::install(std::make_unique<detail::theme_table>(
+      std::vector<detail::theme_style>{}));
+}
+
+}  // namespace concol
+
+namespace concol_literals {
+
+CONCOL_INLINE std::string operator""_black(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::black, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_blue(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::blue, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_green(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::green, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_cyan(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::cyan, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_red(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::red, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_magenta(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::magenta, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_yellow(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::yellow, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_white(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::white, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_black_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::black_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_blue_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::blue_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_green_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::green_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_cyan_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::cyan_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_red_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::red_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_magenta_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::magenta_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_yellow_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::yellow_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_white_bright(const char* c_str) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::white_bright, c_str, std::strlen(c_str));
+}
+
+CONCOL_INLINE std::string operator""_black(const char* c_str,
+                                           std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::black, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_blue(const char* c_str, std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::blue, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_green(const char* c_str,
+                                           std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::green, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_cyan(const char* c_str, std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::cyan, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_red(const char* c_str, std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::red, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_magenta(const char* c_str,
+                                             std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::magenta, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_yellow(const char* c_str,
+                                            std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::yellow, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_white(const char* c_str,
+                                           std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::white, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_black_bright(const char* c_str,
+                                                  std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::black_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_blue_bright(const char* c_str,
+                                                 std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::blue_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_green_bright(const char* c_str,
+                                                  std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::green_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_cyan_bright(const char* c_str,
+                                                 std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::cyan_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_red_bright(const char* c_str,
+                                                std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::red_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_magenta_bright(const char* c_str,
+                                                    std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::magenta_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_yellow_bright(const char* c_str,
+                                                   std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::yellow_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_white_bright(const char* c_str,
+                                                  std::size_t size) {
+  return concol::detail::tagged_string(
+      concol::detail::color_tags::white_bright, c_str, size);
+}
+
+CONCOL_INLINE std::string operator""_black(const char ch) {
+  std::string str{concol::detail::color_tags::black};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_blue(const char ch) {
+  std::string str{concol::detail::color_tags::blue};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_green(const char ch) {
+  std::string str{concol::detail::color_tags::green};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_cyan(const char ch) {
+  std::string str{concol::detail::color_tags::cyan};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_red(const char ch) {
+  std::string str{concol::detail::color_tags::red};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_magenta(const char ch) {
+  std::string str{concol::detail::color_tags::magenta};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_yellow(const char ch) {
+  std::string str{concol::detail::color_tags::yellow};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_white(const char ch) {
+  std::string str{concol::detail::color_tags::white};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_black_bright(const char ch) {
+  std::string str{concol::detail::color_tags::black_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_blue_bright(const char ch) {
+  std::string str{concol::detail::color_tags::blue_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_green_bright(const char ch) {
+  std::string str{concol::detail::color_tags::green_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_cyan_bright(const char ch) {
+  std::string str{concol::detail::color_tags::cyan_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_red_bright(const char ch) {
+  std::string str{concol::detail::color_tags::red_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_magenta_bright(const char ch) {
+  std::string str{concol::detail::color_tags::magenta_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_yellow_bright(const char ch) {
+  std::string str{concol::detail::color_tags::yellow_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+CONCOL_INLINE std::string operator""_white_bright(const char ch) {
+  std::string str{concol::detail::color_tags::white_bright};
+  str += ch;
+  str += concol::detail::color_tags::reset;
+  return str;
+}
+
+}  // namespace concol_literals
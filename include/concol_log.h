@@ -0,0 +1,159 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#include "concol.h"
+#include "concol_time.h"
+
+// Minimum level compiled in; calls below it expand to nothing and their
+// arguments are never evaluated.
+#define CONCOL_LOG_LEVEL_TRACE 0
+#define CONCOL_LOG_LEVEL_DEBUG 1
+#define CONCOL_LOG_LEVEL_INFO 2
+#define CONCOL_LOG_LEVEL_WARN 3
+#define CONCOL_LOG_LEVEL_ERROR 4
+#define CONCOL_LOG_LEVEL_OFF 5
+
+#ifndef CONCOL_LOG_LEVEL
+#define CONCOL_LOG_LEVEL CONCOL_LOG_LEVEL_TRACE
+#endif
+
+namespace concol {
+
+enum class log_level : int { trace, debug, info, warn, error, off };
+
+class logger final {
+  static std::atomic<int> _level;
+  static std::atomic<bool> _timestamp;
+
+  static void write(const std::string& line);
+  static void append_prefix(log_level, std::string& line);
+  static const char* prefix_markup(log_level) noexcept;
+
+ public:
+  logger() = delete;
+  static void set_level(log_level level) noexcept {
+    _level.store(int(level), std::memory_order_relaxed);
+  }
+  static log_level get_level() noexcept {
+    return log_level(_level.load(std::memory_order_relaxed));
+  }
+  // Prefixes every line with a cached timestamp, see concol_time.h.
+  static void set_timestamp(bool enabled) noexcept {
+    _timestamp.store(enabled, std::memory_order_relaxed);
+  }
+  static bool should_log(log_level level) noexcept {
+    return int(level) >= _level.load(std::memory_order_relaxed);
+  }
+  // Formats one line as "<colored level> <message>\n" and writes it with a
+  // single call, so lines from different threads never interleave.
+  template <typename... Args>
+  static void log(log_level level, const char* fmt, const Args&... args) {
+    CONCOL_AUDIT_SCOPE("logger::log");
+    thread_local std::string fmt_str{};
+    fmt_str.clear();
+#ifndef _WIN32
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+    thread_local std::string line{};
+    line.clear();
+    if (_timestamp.load(std::memory_order_relaxed)) {
+      timestamp::append(line);
+    }
+    append_prefix(level, line);
+    color::append_parsed(fmt_str, fmt, std::char_traits<char>::length(fmt));
+    const auto offset = line.size();
+    line.resize(line.capacity());
+    const auto room = line.size() - offset;
+    const auto result =
+        std::snprintf(&line[offset], room + 1, fmt_str.c_str(), args...);
+    if (result < 0) return;
+    const auto size = std::size_t(result);
+    if (size > room) {
+      line.resize(offset + size);
+      std::snprintf(&line[offset], size + 1, fmt_str.c_str(), args...);
+    }
+    line.resize(offset + size);
+    line += '\n';
+    write(line);
+#pragma GCC diagnostic pop
+#else
+    if (_timestamp.load(std::memory_order_relaxed)) {
+      timestamp::append(fmt_str, true);
+    }
+    fmt_str += prefix_markup(level);
+    fmt_str += fmt;
+    fmt_str += '\n';
+    color::printf(fmt_str.c_str(), args...);
+#endif
+  }
+};
+
+}  // namespace concol
+
+#define CONCOL_LOG(level, ...)                    \
+  do {                                            \
+    if (::concol::logger::should_log(level)) {    \
+      ::concol::logger::log(level, __VA_ARGS__);  \
+    }                                             \
+  } while (false)
+
+#if CONCOL_LOG_LEVEL <= CONCOL_LOG_LEVEL_TRACE
+#define CONCOL_LOG_TRACE(...) \
+  CONCOL_LOG(::concol::log_level::trace, __VA_ARGS__)
+#else
+#define CONCOL_LOG_TRACE(...) ((void)0)
+#endif
+
+#if CONCOL_LOG_LEVEL <= CONCOL_LOG_LEVEL_DEBUG
+#define CONCOL_LOG_DEBUG(...) \
+  CONCOL_LOG(::concol::log_level::debug, __VA_ARGS__)
+#else
+#define CONCOL_LOG_DEBUG(...) ((void)0)
+#endif
+
+#if CONCOL_LOG_LEVEL <= CONCOL_LOG_LEVEL_INFO
+#define CONCOL_LOG_INFO(...) CONCOL_LOG(::concol::log_level::info, __VA_ARGS__)
+#else
+#define CONCOL_LOG_INFO(...) ((void)0)
+#endif
+
+#if CONCOL_LOG_LEVEL <= CONCOL_LOG_LEVEL_WARN
+#define CONCOL_LOG_WARN(...) CONCOL_LOG(::concol::log_level::warn, __VA_ARGS__)
+#else
+#define CONCOL_LOG_WARN(...) ((void)0)
+#endif
+
+#if CONCOL_LOG_LEVEL <= CONCOL_LOG_LEVEL_ERROR
+#define CONCOL_LOG_ERROR(...) \
+  CONCOL_LOG(::concol::log_level::error, __VA_ARGS__)
+#else
+#define CONCOL_LOG_ERROR(...) ((void)0)
+#endif
@@ -0,0 +1,109 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "concol.h"
+#include "concol_text.h"
+
+namespace concol {
+
+// Append-only log file written through a shared memory mapping: the file
+// is extended to `max_size` up front, so appending a message is a memcpy
+// (or an escape-stripping copy) with no syscall. Its blocks are reserved
+// with posix_fallocate(), so a full disk fails the open (the constructor
+// throws, a rotation counts the messages as dropped) instead of raising
+// SIGBUS on a later store. Where space cannot be reserved (macOS, some file
+// systems) the file is sparse and that hazard remains. Dirty pages are
+// handed to msync(MS_ASYNC) every sync_interval() bytes. When the next
+// message does not fit, the file is truncated to its contents and rotated
+// to `path.1` ... `path.<max_files>`. Reopening a file left padded with
+// zeros by a crash recovers its length from the last non-zero byte and
+// appends after it. POSIX only; elsewhere the constructor throws
+// std::system_error.
+class mmap_sink final : public detail::output_sink {
+  std::string _path{};
+  // path.1 ... path.<max_files>, built once so rotation does not allocate.
+  std::vector<std::string> _rotated{};
+  std::size_t _max_size{};
+  unsigned _max_files{};
+  bool _strip{};
+  ansi_stripper _stripper{};
+  int _fd{-1};
+  char* _map{};
+  std::size_t _length{};
+  std::size_t _synced{};
+  std::size_t _sync_interval{1024 * 1024};
+  std::uint64_t _dropped{};
+  int _error{};
+  mutable std::mutex _mutex{};
+
+  void open();
+  void close() noexcept;
+  void rotate_files() noexcept;
+  bool reopen() noexcept;
+
+ public:
+  explicit mmap_sink(const std::string& path,
+                     std::size_t max_size = 64 * 1024 * 1024,
+                     unsigned max_files = 4, bool strip = false);
+  mmap_sink(const mmap_sink&) = delete;
+  mmap_sink& operator=(const mmap_sink&) = delete;
+  // Uninstalls itself if it is still the active sink, then syncs and
+  // truncates the file to its contents.
+  ~mmap_sink();
+
+  void write(const char* data, std::size_t size) noexcept override;
+  void install() noexcept { color::set_sink(this); }
+  // Waits for every byte written so far to reach the file (MS_SYNC).
+  void sync() noexcept;
+  // Starts a new file now.
+  void rotate() noexcept;
+  void set_sync_interval(std::size_t bytes) noexcept;
+
+  // Bytes in the current file.
+  std::size_t size() const noexcept;
+  // Messages lost: larger than max_size, or written while no file could
+  // be opened.
+  std::uint64_t dropped() const noexcept;
+  // errno of the last failed file operation, or 0.
+  int error() const noexcept;
+  const std::string& path() const noexcept { return _path; }
+};
+
+namespace detail {
+
+// Length of a file's contents without the zero padding at its end.
+std::size_t recover_length(const char* data, std::size_t size) noexcept;
+
+}  // namespace detail
+
+}  // namespace concol
@@ -0,0 +1,81 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "concol.h"
+
+namespace concol {
+
+// Multiplexes the output of child processes onto color's stream, the way
+// parallel build wrappers do: every line is prefixed with the child's
+// colored name and written whole. All children are served by one epoll
+// loop on the calling thread (Linux only; elsewhere the constructor
+// throws std::system_error).
+class output_mux final {
+  struct source {
+    int fd;
+    std::string prefix;
+    std::string partial;
+  };
+
+  int _epoll{-1};
+  std::vector<std::unique_ptr<source>> _sources{};
+  std::vector<char> _buffer{};
+  std::string _out{};
+
+  void split(source& src, const char* data, std::size_t size);
+  void close(source& src);
+
+ public:
+  // Longest line kept back while waiting for its newline.
+  static constexpr std::size_t max_line{64 * 1024};
+
+  explicit output_mux(std::size_t read_size = 64 * 1024);
+  output_mux(const output_mux&) = delete;
+  output_mux& operator=(const output_mux&) = delete;
+  ~output_mux();
+
+  // Reads the lines of `fd` (e.g. the read end of a pipe); the mux owns and
+  // closes it.
+  void adopt(int fd, const std::string& name, color_type fg);
+  // Runs `command` with /bin/sh, its stdout and stderr on one pipe, and
+  // adopts the pipe. Returns the child pid; reaping it is up to the caller.
+  int spawn(const std::string& command, const std::string& name,
+            color_type fg);
+  // Waits up to timeout_ms (-1 for ever) for output and writes the complete
+  // lines with one write. Returns the number of sources still open.
+  std::size_t poll(int timeout_ms = -1);
+  // Polls until every source has reached end of file.
+  void run();
+  std::size_t size() const noexcept { return _sources.size(); }
+};
+
+}  // namespace concol
@@ -0,0 +1,216 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include "concol.h"
+
+namespace concol {
+
+// Log-linear latency histogram in the spirit of HdrHistogram: values below
+// 8 ns are exact, above that every power of two is split into 8 buckets,
+// so a value is reported at most 12.5% high. Up to about 68 s; longer
+// values land in the last bucket. Recording is one relaxed atomic add.
+class latency_histogram final {
+ public:
+  static constexpr int sub_bucket_bits{3};
+  static constexpr int max_exponent{36};
+  static constexpr std::size_t bucket_count{
+      std::size_t(max_exponent - sub_bucket_bits + 2) << sub_bucket_bits};
+
+ private:
+  std::atomic<std::uint64_t> _buckets[bucket_count]{};
+  std::atomic<std::uint64_t> _count{};
+  std::atomic<std::uint64_t> _total{};
+
+ public:
+  static std::size_t bucket_index(std::uint64_t ns) noexcept;
+  // Largest value that falls into the bucket.
+  static std::uint64_t bucket_limit(std::size_t index) noexcept;
+
+  void record(std::uint64_t ns) noexcept {
+    _buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _total.fetch_add(ns, std::memory_order_relaxed);
+  }
+  std::uint64_t count() const noexcept {
+    return _count.load(std::memory_order_relaxed);
+  }
+  std::uint64_t total() const noexcept {
+    return _total.load(std::memory_order_relaxed);
+  }
+  // Upper limit of the bucket that holds the `quantile` (0 to 1) value.
+  std::uint64_t percentile(double quantile) const noexcept;
+  void reset() noexcept;
+};
+
+enum class profile_phase : int { parse, format, write };
+enum class profile_order : int { time, bytes };
+
+// Statistics of one CONCOL_PROFILE_* call site: calls, bytes written and a
+// histogram per phase. Like the throttles of concol_throttle.h, sites join
+// a mutex-guarded list when they are created and leave it when they are
+// destroyed; record() never takes the lock.
+class callsite_profile final {
+  static std::mutex _mutex;
+  static callsite_profile* _head;
+
+  const char* _file{};
+  int _line{};
+  std::atomic<std::uint64_t> _calls{};
+  std::atomic<std::uint64_t> _bytes{};
+  latency_histogram _phases[3]{};
+  callsite_profile* _next{};
+
+ public:
+  callsite_profile(const char* file, int line);
+  callsite_profile(const callsite_profile&) = delete;
+  callsite_profile& operator=(const callsite_profile&) = delete;
+  ~callsite_profile();
+
+  static std::uint64_t now() noexcept {
+    return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now()
+                                 .time_since_epoch())
+                             .count());
+  }
+  void record(std::uint64_t parse_ns, std::uint64_t format_ns,
+              std::uint64_t write_ns, std::size_t bytes) noexcept;
+
+  const char* file() const noexcept { return _file; }
+  int line() const noexcept { return _line; }
+  std::uint64_t calls() const noexcept {
+    return _calls.load(std::memory_order_relaxed);
+  }
+  std::uint64_t bytes() const noexcept {
+    return _bytes.load(std::memory_order_relaxed);
+  }
+  std::uint64_t total_ns() const noexcept;
+  const latency_histogram& phase(profile_phase phase) const noexcept {
+    return _phases[int(phase)];
+  }
+
+  // Calls `function(const callsite_profile&)` for every live site, most
+  // recently registered first, with the list locked.
+  template <typename Function>
+  static void for_each(Function&& function) {
+    std::lock_guard<std::mutex> lock{_mutex};
+    for (auto site = _head; site != nullptr; site = site->_next) {
+      function(*site);
+    }
+  }
+  // Prints the `top` sites by total time or bytes, with the median and
+  // 99th percentile of every phase in ns.
+  static void report(std::FILE* stream = stderr, std::size_t top = 20,
+                     profile_order order = profile_order::time);
+  static void reset_all();
+};
+
+namespace detail {
+
+// color::printf split into its phases: tag expansion into a per-thread
+// buffer, snprintf into another, and color::write.
+template <typename... Args>
+void profiled_printf(callsite_profile& site, const char* fmt,
+                     const Args&... args) {
+#ifndef _WIN32
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+  thread_local std::string parsed{};
+  thread_local std::string out(256, '\0');
+  const auto start = callsite_profile::now();
+  parsed.clear();
+  color::append_parsed(parsed, fmt, std::strlen(fmt));
+  const auto parsed_at = callsite_profile::now();
+  auto size = std::snprintf(&out[0], out.size(), parsed.c_str(), args...);
+  if (size < 0) return;
+  if (std::size_t(size) >= out.size()) {
+    out.resize(std::size_t(size) + 1);
+    std::snprintf(&out[0], out.size(), parsed.c_str(), args...);
+  }
+  const auto formatted_at = callsite_profile::now();
+  color::write(out.data(), std::size_t(size));
+  const auto written_at = callsite_profile::now();
+  site.record(parsed_at - start, formatted_at - parsed_at,
+              written_at - formatted_at, std::size_t(size));
+#pragma GCC diagnostic pop
+#else
+  // The console API path cannot be split; it is timed as a write.
+  const auto start = callsite_profile::now();
+  color::printf(fmt, args...);
+  site.record(0, 0, callsite_profile::now() - start, 0);
+#endif
+}
+
+// print_* calls and other statements are timed as a whole, as a write.
+template <typename Print>
+void profiled_print(callsite_profile& site, Print&& print) {
+  const auto start = callsite_profile::now();
+  print();
+  site.record(0, 0, callsite_profile::now() - start, 0);
+}
+
+}  // namespace detail
+
+}  // namespace concol
+
+// Instrumented color::printf and print_* calls. With CONCOL_PROFILE
+// defined, every call site keeps a callsite_profile; otherwise the macros
+// are the plain calls and leave nothing behind.
+#ifdef CONCOL_PROFILE
+#define CONCOL_PROFILE_PRINTF(...)                                      \
+  do {                                                                  \
+    static ::concol::callsite_profile concol_profile_{__FILE__,         \
+                                                      __LINE__};        \
+    ::concol::detail::profiled_printf(concol_profile_, __VA_ARGS__);    \
+  } while (false)
+
+#define CONCOL_PROFILE_PRINT(...)                                       \
+  do {                                                                  \
+    static ::concol::callsite_profile concol_profile_{__FILE__,         \
+                                                      __LINE__};        \
+    ::concol::detail::profiled_print(concol_profile_,                   \
+                                     [&] { __VA_ARGS__; });             \
+  } while (false)
+#else
+#define CONCOL_PROFILE_PRINTF(...)                                      \
+  do {                                                                  \
+    ::concol::color::printf(__VA_ARGS__);                               \
+  } while (false)
+
+#define CONCOL_PROFILE_PRINT(...)                                       \
+  do {                                                                  \
+    __VA_ARGS__;                                                        \
+  } while (false)
+#endif
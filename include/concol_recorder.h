@@ -0,0 +1,74 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "concol.h"
+
+namespace concol {
+
+// Ring buffer that keeps the last `capacity` bytes written through concol,
+// colored or with escape sequences stripped. Writers reserve space with one
+// atomic add and copy their bytes in, without locks; a snapshot taken while
+// writers are active is best effort. dump() does not allocate and may be
+// called from a crash handler.
+class flight_recorder final : public detail::output_tee {
+  std::unique_ptr<char[]> _buffer{};
+  std::size_t _mask{};
+  std::atomic<std::uint64_t> _head{};
+  bool _colored{};
+
+  void store(std::uint64_t pos, const char* data, std::size_t size) noexcept;
+  // Oldest retained byte, moved past the first line break once the buffer
+  // has wrapped so that the copy starts with a whole line.
+  std::uint64_t first(std::uint64_t head) const noexcept;
+
+ public:
+  explicit flight_recorder(std::size_t capacity = 64 * 1024,
+                           bool colored = true);
+  flight_recorder(const flight_recorder&) = delete;
+  flight_recorder& operator=(const flight_recorder&) = delete;
+  // Uninstalls itself if it is still the active tee; no thread may be
+  // writing through concol at that point.
+  ~flight_recorder();
+
+  void write(const char* data, std::size_t size) noexcept override;
+  // Starts recording everything written by color::printf, the logger,
+  // deferred_printer and table::print.
+  void install() noexcept { color::set_tee(this); }
+  std::size_t capacity() const noexcept { return _mask + 1; }
+  std::size_t size() const noexcept;
+  std::string snapshot() const;
+  // Writes the retained output to a file descriptor with write(2).
+  void dump(int fd) const noexcept;
+};
+
+}  // namespace concol
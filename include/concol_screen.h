@@ -0,0 +1,84 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "concol.h"
+
+namespace concol {
+
+struct screen_cell {
+  // A wide character is followed by a cell with ch == 0 that continues it.
+  char32_t ch{U' '};
+  color_type fg{color_type::none};
+  color_type bg{color_type::none};
+
+  bool operator==(const screen_cell& rhs) const noexcept {
+    return ch == rhs.ch && fg == rhs.fg && bg == rhs.bg;
+  }
+  bool operator!=(const screen_cell& rhs) const noexcept {
+    return !(*this == rhs);
+  }
+};
+
+// Double-buffered full-screen model. Drawing goes to the back buffer;
+// present() diffs it against what the terminal shows and sends only the
+// changed cells, with cursor moves and style changes kept to a minimum, in
+// a single write.
+class screen final {
+  std::size_t _width{};
+  std::size_t _height{};
+  std::vector<screen_cell> _back{};
+  std::vector<screen_cell> _front{};
+  std::string _out{};
+
+ public:
+  screen(std::size_t width, std::size_t height);
+  std::size_t width() const noexcept { return _width; }
+  std::size_t height() const noexcept { return _height; }
+  void resize(std::size_t width, std::size_t height);
+  void clear(const screen_cell& fill = screen_cell{});
+  void put(std::size_t x, std::size_t y, char32_t ch,
+           color_type fg = color_type::none, color_type bg = color_type::none);
+  const screen_cell& at(std::size_t x, std::size_t y) const noexcept {
+    return _back[y * _width + x];
+  }
+  // Draws UTF-8 concol markup from (x, y), clipped at the right edge; the
+  // reset tag goes back to `fg`. Returns the number of columns drawn.
+  std::size_t print(std::size_t x, std::size_t y, std::string_view markup,
+                    color_type fg = color_type::none,
+                    color_type bg = color_type::none);
+  // Forgets what the terminal shows, so the next frame is drawn in full.
+  void invalidate();
+  // Appends the bytes that turn the previous frame into the current one.
+  void render(std::string& out);
+  void present();
+};
+
+}  // namespace concol
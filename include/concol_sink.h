@@ -0,0 +1,104 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "concol.h"
+
+namespace concol {
+
+// Output sink for file descriptors in O_NONBLOCK mode, such as pipes shared
+// with other processes. A write that the descriptor does not take at once
+// is kept in a bounded ring buffer and sent before anything newer, so a
+// message is never cut in the middle. When the buffer cannot hold a new
+// message, the whole message is dropped and the next accepted one starts
+// with a color reset, so a lost "{}" never leaves the terminal colored.
+// POSIX only; elsewhere the constructor throws std::system_error.
+class fd_sink final : public detail::output_sink {
+ public:
+  // Called without the lock held whenever the pending bytes rise above the
+  // high watermark.
+  using watermark_callback = std::function<void(std::size_t pending)>;
+
+ private:
+  int _fd{-1};
+  std::unique_ptr<char[]> _buffer{};
+  std::size_t _capacity{};
+  std::size_t _head{};
+  std::size_t _size{};
+  std::size_t _high_watermark{};
+  watermark_callback _on_high_watermark{};
+  bool _above_watermark{};
+  bool _reset_pending{};
+  int _error{};
+  std::uint64_t _dropped{};
+  mutable std::mutex _mutex{};
+
+  // Writes as much of the buffer as the descriptor takes. Errors other than
+  // EAGAIN discard the buffer and return false.
+  bool send_pending() noexcept;
+  // Writes directly and returns the number of bytes taken; `failed` is set
+  // on errors other than EAGAIN.
+  std::size_t send(const char* data, std::size_t size, bool& failed) noexcept;
+  void push(const char* data, std::size_t size) noexcept;
+  void fail(int error) noexcept;
+  bool check_watermark() noexcept;
+
+ public:
+  explicit fd_sink(int fd, std::size_t capacity = 1024 * 1024);
+  fd_sink(const fd_sink&) = delete;
+  fd_sink& operator=(const fd_sink&) = delete;
+  // Uninstalls itself if it is still the active sink and makes one last
+  // non-blocking attempt to send what is pending. Does not close the fd.
+  ~fd_sink();
+
+  void write(const char* data, std::size_t size) noexcept override;
+  // Routes color::printf, the logger and color::write to the descriptor.
+  void install() noexcept { color::set_sink(this); }
+
+  // Sends pending bytes without blocking; returns the bytes still pending.
+  std::size_t flush() noexcept;
+  // Waits with poll(2) up to timeout_ms (-1 for ever) for the buffer to
+  // drain; returns the bytes still pending.
+  std::size_t flush(int timeout_ms) noexcept;
+
+  // Set before install(): the callback is not synchronized with writers.
+  void set_high_watermark(std::size_t bytes, watermark_callback callback);
+  std::size_t pending() const noexcept;
+  std::size_t capacity() const noexcept { return _capacity; }
+  // Messages dropped because the buffer was full or the fd failed.
+  std::uint64_t dropped() const noexcept;
+  // errno of the last failed write other than EAGAIN, or 0.
+  int error() const noexcept;
+  int fd() const noexcept { return _fd; }
+};
+
+}  // namespace concol
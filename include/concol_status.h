@@ -0,0 +1,122 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concol.h"
+
+namespace concol {
+
+// Counter of one bar; safe to update from any thread with relaxed atomics.
+class progress_bar final {
+  std::atomic<std::uint64_t> _current{};
+  std::atomic<std::uint64_t> _total{};
+  std::string _label{};
+  color_type _fg{color_type::green};
+
+  friend class status_line;
+
+ public:
+  progress_bar(std::string label, std::uint64_t total, color_type fg);
+  progress_bar(const progress_bar&) = delete;
+  progress_bar& operator=(const progress_bar&) = delete;
+  void add(std::uint64_t delta = 1) noexcept {
+    _current.fetch_add(delta, std::memory_order_relaxed);
+  }
+  void set(std::uint64_t value) noexcept {
+    _current.store(value, std::memory_order_relaxed);
+  }
+  void set_total(std::uint64_t total) noexcept {
+    _total.store(total, std::memory_order_relaxed);
+  }
+  std::uint64_t current() const noexcept {
+    return _current.load(std::memory_order_relaxed);
+  }
+  std::uint64_t total() const noexcept {
+    return _total.load(std::memory_order_relaxed);
+  }
+};
+
+// Block of progress bars kept at the bottom of the terminal. Every frame is
+// diffed against the previous one and only the changed cells are repainted,
+// at most max_fps times per second. Labels are measured in terminal columns
+// with visible_width(), so UTF-8 labels keep the bars aligned. Bars are added and frames are rendered
+// from a single thread (or by start()), while the bars themselves may be
+// updated concurrently from any number of workers.
+class status_line final {
+  // One byte of the line. The bytes of a UTF-8 label character, and the
+  // zero-width marks that follow it, share the column of its first byte.
+  struct cell {
+    char ch;
+    color_type fg;
+    std::size_t column;
+    bool operator==(const cell& rhs) const noexcept {
+      return ch == rhs.ch && fg == rhs.fg;
+    }
+    bool operator!=(const cell& rhs) const noexcept { return !(*this == rhs); }
+  };
+
+  std::deque<progress_bar> _bars{};
+  std::vector<std::vector<cell>> _frame{};
+  std::vector<cell> _line{};
+  std::size_t _width{};
+  std::atomic<std::chrono::steady_clock::rep> _interval{};
+  std::chrono::steady_clock::time_point _last{};
+  std::string _out{};
+  std::thread _thread{};
+  std::atomic<bool> _running{};
+
+  void layout(const progress_bar&, std::size_t label_width);
+  void append_cells(std::string& out, const cell* first, const cell* last,
+                    color_type& current) const;
+
+ public:
+  explicit status_line(unsigned max_fps = 30, std::size_t width = 80);
+  status_line(const status_line&) = delete;
+  status_line& operator=(const status_line&) = delete;
+  ~status_line();
+  progress_bar& add_bar(std::string label, std::uint64_t total,
+                        color_type fg = color_type::green);
+  void set_max_fps(unsigned max_fps) noexcept;
+  // Appends the escape sequences that bring the terminal from the last
+  // rendered frame to the current one; appends nothing if nothing changed.
+  void render(std::string& out);
+  // Renders and writes a frame unless the previous one is younger than the
+  // frame interval. Returns true if a frame was written.
+  bool refresh(bool force = false);
+  // Repaints from a background thread at max_fps until stop().
+  void start();
+  void stop();
+};
+
+}  // namespace concol
@@ -0,0 +1,131 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "concol.h"
+
+namespace concol {
+
+enum class table_align : int { left, right };
+
+// A cell is concol markup ("{red}%s{}" style tags are expanded), optionally
+// wrapped as a whole in one color.
+struct table_cell {
+  std::string_view text{};
+  color_type fg{color_type::none};
+
+  table_cell() = default;
+  table_cell(const char* str) : text{str} {}
+  table_cell(const std::string& str) : text{str} {}
+  table_cell(std::string_view str, color_type fg_key = color_type::none)
+      : text{str}, fg{fg_key} {}
+};
+
+namespace detail {
+
+class table_layout {
+ protected:
+  std::vector<std::size_t> _widths{};
+  std::vector<table_align> _aligns{};
+  std::string _separator{" "};
+
+  explicit table_layout(std::size_t columns)
+      : _widths(columns), _aligns(columns, table_align::left) {}
+  // Expands a cell into `out` and returns its visible width.
+  static std::size_t append_cell(std::string& out, const table_cell& cell);
+  void append_padded(std::string& out, const char* text, std::size_t size,
+                     std::size_t width, std::size_t column) const;
+
+ public:
+  std::size_t columns() const noexcept { return _widths.size(); }
+};
+
+}  // namespace detail
+
+// Whole table kept in memory: cells are expanded once into a single arena,
+// column widths are tracked as rows are added, and the table is rendered
+// into one exactly pre-sized buffer.
+class table final : public detail::table_layout {
+  struct cell_ref {
+    std::size_t offset;
+    std::size_t size;
+    std::size_t width;
+  };
+
+  std::string _text{};
+  std::vector<cell_ref> _cells{};
+
+ public:
+  explicit table(std::size_t columns) : table_layout{columns} {}
+  table& set_align(std::size_t column, table_align align);
+  table& set_separator(std::string separator);
+  void reserve(std::size_t rows, std::size_t text_bytes = 0);
+  // Missing trailing cells are rendered empty; extra cells are ignored.
+  table& add_row(std::initializer_list<table_cell> cells);
+  table& add_row(const table_cell* cells, std::size_t count);
+  std::size_t rows() const noexcept {
+    return (columns() == 0) ? 0 : _cells.size() / columns();
+  }
+  std::size_t width(std::size_t column) const noexcept {
+    return _widths[column];
+  }
+  void clear() noexcept;
+  void render(std::string& out) const;
+  std::string to_string() const;
+  void print() const;
+};
+
+// Streaming variant for unbounded row counts: column widths are fixed up
+// front, wider cells are truncated to fit, and rendered rows are buffered
+// and written whenever the buffer reaches chunk_size. Without a stream the
+// rows go through color::write(), like table::print().
+class table_writer final : public detail::table_layout {
+  std::string _buffer{};
+  std::string _cell{};
+  std::FILE* _stream{};
+  std::size_t _chunk_size{};
+
+ public:
+  explicit table_writer(std::vector<std::size_t> widths,
+                        std::FILE* stream = nullptr,
+                        std::size_t chunk_size = std::size_t(1) << 16);
+  table_writer(const table_writer&) = delete;
+  table_writer& operator=(const table_writer&) = delete;
+  ~table_writer();
+  table_writer& set_align(std::size_t column, table_align align);
+  table_writer& set_separator(std::string separator);
+  table_writer& add_row(std::initializer_list<table_cell> cells);
+  table_writer& add_row(const table_cell* cells, std::size_t count);
+  void flush();
+};
+
+}  // namespace concol
@@ -0,0 +1,87 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace concol {
+
+// How escapes are spelled in the text being measured: concol tags such as
+// "{+red}" or rendered ANSI sequences such as "\x1b[0;31;1m".
+enum class text_format : int { markup, ansi };
+
+// Number of terminal columns the text takes once printed. UTF-8 aware;
+// tags, escape sequences and combining marks take no columns.
+std::size_t visible_width(std::string_view str,
+                          text_format format = text_format::ansi) noexcept;
+
+// Longest prefix of `str` that fits in `width` columns. The cut never falls
+// inside an escape sequence, a tag or a UTF-8 code point, and zero-width
+// elements that directly follow the last visible character are kept.
+std::string_view truncate_to_width(
+    std::string_view str, std::size_t width,
+    text_format format = text_format::ansi) noexcept;
+
+// Removes escape sequences (CSI such as SGR colors, OSC and plain ESC
+// sequences) from text that arrives in chunks. A sequence split between
+// chunks is tracked by a small state machine, so memory stays bounded.
+class ansi_stripper final {
+  enum class state : int { plain, escape, csi, osc, osc_escape };
+  state _state{state::plain};
+
+  char* strip(const char* pos, const char* end, char* out) noexcept;
+
+ public:
+  // Appends the plain text of `chunk` to `out`.
+  void feed(std::string_view chunk, std::string& out);
+  // Strips `size` bytes at `str` in place; returns the plain size.
+  std::size_t feed(char* str, std::size_t size) noexcept;
+  // Writes the plain text of `size` bytes at `data` to `out`, which has room
+  // for `size` bytes; returns the plain size.
+  std::size_t feed(const char* data, std::size_t size, char* out) noexcept;
+  // Forgets an unfinished sequence.
+  void reset() noexcept { _state = state::plain; }
+};
+
+// One-shot forms of ansi_stripper; an unfinished trailing sequence is
+// dropped.
+std::string strip_ansi(std::string_view str);
+std::size_t strip_ansi(char* str, std::size_t size) noexcept;
+
+namespace detail {
+
+// Terminal columns taken by a code point: 0 for combining marks, 2 for East
+// Asian wide and emoji ranges, 1 otherwise.
+std::size_t codepoint_width(char32_t) noexcept;
+
+// Size of the escape sequence starting at `str` (which must point at ESC),
+// or 0 if the sequence is not complete before `end`.
+std::size_t ansi_sequence_size(const char* str, const char* end) noexcept;
+
+}  // namespace detail
+}  // namespace concol
@@ -0,0 +1,132 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "concol.h"
+
+namespace concol {
+
+// State shared by all throttles of one call site: the number of dropped
+// messages and the time of the last "suppressed" summary. Sites register
+// themselves in a list so report_all() can flush every summary; the list is
+// only locked when a site is created or destroyed and by report_all(), never
+// on the allow() path.
+class callsite_throttle {
+  static std::mutex _mutex;
+  static callsite_throttle* _head;
+
+  const char* _file{};
+  int _line{};
+  std::atomic<std::uint64_t> _suppressed{};
+  std::atomic<std::int64_t> _last_report{};
+  callsite_throttle* _next{};
+
+ protected:
+  callsite_throttle(const char* file, int line);
+  ~callsite_throttle();
+  static std::int64_t now() noexcept;
+  void drop() noexcept {
+    _suppressed.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Prints the summary when messages were dropped and the previous summary
+  // of this site is at least report_interval old. Called on both the allow
+  // and the drop path.
+  void maybe_report(std::int64_t now_ns) {
+    if (_suppressed.load(std::memory_order_relaxed) != 0) {
+      report(now_ns, false);
+    }
+  }
+
+ public:
+  static constexpr std::int64_t report_interval{1000000000};
+  callsite_throttle(const callsite_throttle&) = delete;
+  callsite_throttle& operator=(const callsite_throttle&) = delete;
+  std::uint64_t suppressed() const noexcept {
+    return _suppressed.load(std::memory_order_relaxed);
+  }
+  void report(std::int64_t now_ns, bool force);
+  // Prints the pending summary of every site.
+  static void report_all();
+};
+
+// Token bucket in its GCRA form: a single atomic "theoretical arrival time"
+// updated with one CAS, `per_second` messages on average and up to `burst`
+// back to back. A rate of zero or below lets nothing through. allow() may
+// print a summary and therefore throw like color::printf.
+class rate_limiter final : public callsite_throttle {
+  std::atomic<std::int64_t> _arrival{};
+  std::int64_t _interval{};
+  std::int64_t _tolerance{};
+
+ public:
+  rate_limiter(double per_second, unsigned burst, const char* file = "",
+               int line = 0);
+  bool allow();
+};
+
+// Lets the first of every `every` messages through.
+class sampler final : public callsite_throttle {
+  std::atomic<std::uint64_t> _count{};
+  std::uint64_t _every{};
+
+ public:
+  sampler(std::uint64_t every, const char* file = "", int line = 0)
+      : callsite_throttle{file, line}, _every{(every == 0) ? 1 : every} {}
+  bool allow() {
+    if (_count.fetch_add(1, std::memory_order_relaxed) % _every != 0) {
+      drop();
+      maybe_report(now());
+      return false;
+    }
+    maybe_report(now());
+    return true;
+  }
+};
+
+}  // namespace concol
+
+// Throttled color::printf: when the site is over its quota the arguments are
+// neither evaluated nor formatted.
+#define CONCOL_PRINTF_RATE_LIMITED(per_second, burst, ...)                  \
+  do {                                                                     \
+    static ::concol::rate_limiter concol_callsite_{per_second, burst,      \
+                                                   __FILE__, __LINE__};    \
+    if (concol_callsite_.allow()) {                                        \
+      ::concol::color::printf(__VA_ARGS__);                                \
+    }                                                                      \
+  } while (false)
+
+#define CONCOL_PRINTF_SAMPLED(every, ...)                                   \
+  do {                                                                     \
+    static ::concol::sampler concol_callsite_{every, __FILE__, __LINE__};  \
+    if (concol_callsite_.allow()) {                                        \
+      ::concol::color::printf(__VA_ARGS__);                                \
+    }                                                                      \
+  } while (false)
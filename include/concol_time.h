@@ -0,0 +1,60 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "concol.h"
+
+namespace concol {
+
+// "YYYY-MM-DD hh:mm:ss.fff " prefix for log lines. Each thread keeps the
+// rendered text of the current second and only patches the sub-second
+// digits per call; the date and time are formatted again only when the
+// second changes.
+class timestamp final {
+  static std::atomic<unsigned> _generation;
+  static std::mutex _mutex;
+  static std::string _style;
+  static unsigned _precision;
+  static bool _utc;
+
+ public:
+  timestamp() = delete;
+  // Opening tag used to color the timestamp, e.g. "{+black}"; empty for no
+  // color.
+  static void set_style(const std::string& tag);
+  // Number of sub-second digits: 0, 3 (default), 6 or 9.
+  static void set_precision(unsigned digits);
+  static void set_utc(bool utc);
+  // Appends the timestamp; with `markup` the style is appended as a tag
+  // instead of an escape sequence.
+  static void append(std::string& out, bool markup = false);
+};
+
+}  // namespace concol
@@ -0,0 +1,106 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "concol.h"
+
+namespace concol {
+
+// Output sink for regular files on fast storage. Messages are copied into
+// a ring of buffers; full buffers are queued as io_uring writes at explicit
+// file offsets (fixed writes when the buffers could be registered) and
+// submitted several per io_uring_enter, so a syscall moves hundreds of KB.
+// Where io_uring is unavailable, and for pipes or O_APPEND descriptors, the
+// queued buffers go out with one writev instead. The ring is driven with
+// raw syscalls, without liburing. Linux only; elsewhere the constructor
+// throws std::system_error.
+class uring_sink final : public detail::output_sink {
+  struct buffer {
+    char* data;
+    std::size_t size;
+    std::uint64_t offset;
+    bool busy;
+  };
+  // Ring mappings and iovecs; the ring fd is -1 on the writev path.
+  struct ring;
+
+  int _fd{-1};
+  std::unique_ptr<char[]> _storage{};
+  std::unique_ptr<buffer[]> _buffers{};
+  std::size_t _buffer_size{};
+  unsigned _count{};
+  unsigned _current{};
+  // Buffers filled but not yet handed to the kernel, oldest first.
+  unsigned _queued{};
+  unsigned _in_flight{};
+  std::uint64_t _offset{};
+  // Writes go to explicit offsets, from the file position at construction.
+  bool _positional{};
+  std::unique_ptr<ring> _ring;
+  std::uint64_t _syscalls{};
+  std::uint64_t _failed{};
+  int _error{};
+  mutable std::mutex _mutex{};
+
+  void setup_ring(bool use_io_uring) noexcept;
+  void queue_current() noexcept;
+  void submit(bool wait_one) noexcept;
+  void reap() noexcept;
+  void abandon_ring(int error) noexcept;
+  void write_queued() noexcept;
+  void finish(buffer& buf, long result) noexcept;
+  void flush_locked() noexcept;
+
+ public:
+  // `buffers` buffers of `buffer_size` bytes each; with use_io_uring false
+  // the writev path is used unconditionally.
+  explicit uring_sink(int fd, std::size_t buffer_size = 256 * 1024,
+                      unsigned buffers = 8, bool use_io_uring = true);
+  uring_sink(const uring_sink&) = delete;
+  uring_sink& operator=(const uring_sink&) = delete;
+  // Uninstalls itself if it is still the active sink and flushes. Does not
+  // close the fd.
+  ~uring_sink();
+
+  void write(const char* data, std::size_t size) noexcept override;
+  void install() noexcept { color::set_sink(this); }
+  // Writes out the partly filled buffer and waits for every pending write.
+  void flush() noexcept;
+
+  bool uses_io_uring() const noexcept;
+  // io_uring_enter, writev and pwrite calls made so far.
+  std::uint64_t syscalls() const noexcept;
+  // Writes that failed; error() holds the errno of the last one.
+  std::uint64_t failed() const noexcept;
+  int error() const noexcept;
+};
+
+}  // namespace concol
@@ -0,0 +1,188 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_audit.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifndef CONCOL_ALLOC_AUDIT
+#error "concol_audit.cpp is only built with CONCOL_ALLOC_AUDIT"
+#endif
+
+namespace concol {
+namespace detail {
+
+struct audit_entry {
+  std::atomic<const char*> name;
+  std::atomic<std::uint64_t> calls;
+  std::atomic<std::uint64_t> allocations;
+  std::atomic<std::uint64_t> bytes;
+};
+
+}  // namespace detail
+}  // namespace concol
+
+using namespace concol;
+using namespace concol::detail;
+
+namespace {
+
+// Fixed storage: the operator new hook must not allocate itself.
+constexpr std::size_t max_entries{128};
+audit_entry entries[max_entries]{};
+audit_entry overflow{};
+std::atomic<std::size_t> entry_count{};
+
+thread_local audit_entry* current{};
+
+void charge(std::size_t size) noexcept {
+  if (current != nullptr) {
+    current->allocations.fetch_add(1, std::memory_order_relaxed);
+    current->bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+audit_entry& detail::audit_register(const char* name) noexcept {
+  static std::atomic_flag lock = ATOMIC_FLAG_INIT;
+  while (lock.test_and_set(std::memory_order_acquire)) {
+  }
+  audit_entry* entry{&overflow};
+  const auto count = entry_count.load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (std::strcmp(entries[i].name.load(std::memory_order_relaxed), name) ==
+        0) {
+      entry = &entries[i];
+      break;
+    }
+  }
+  if (entry == &overflow && count < max_entries) {
+    entry = &entries[count];
+    entry->name.store(name, std::memory_order_relaxed);
+    entry_count.store(count + 1, std::memory_order_release);
+  }
+  lock.clear(std::memory_order_release);
+  return *entry;
+}
+
+audit_scope::audit_scope(audit_entry& entry) noexcept : _previous{current} {
+  if (current == nullptr) {
+    entry.calls.fetch_add(1, std::memory_order_relaxed);
+    current = &entry;
+  }
+}
+
+audit_scope::~audit_scope() {
+  if (_previous == nullptr) current = nullptr;
+}
+
+std::vector<alloc_audit_entry> alloc_audit::snapshot() {
+  std::vector<alloc_audit_entry> result{};
+  const auto count = entry_count.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < count; ++i) {
+    result.push_back(alloc_audit_entry{
+        entries[i].name.load(std::memory_order_relaxed),
+        entries[i].calls.load(std::memory_order_relaxed),
+        entries[i].allocations.load(std::memory_order_relaxed),
+        entries[i].bytes.load(std::memory_order_relaxed)});
+  }
+  return result;
+}
+
+alloc_audit_entry alloc_audit::find(const char* name) noexcept {
+  const auto count = entry_count.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto entry_name = entries[i].name.load(std::memory_order_relaxed);
+    if (std::strcmp(entry_name, name) == 0) {
+      return alloc_audit_entry{
+          entry_name, entries[i].calls.load(std::memory_order_relaxed),
+          entries[i].allocations.load(std::memory_order_relaxed),
+          entries[i].bytes.load(std::memory_order_relaxed)};
+    }
+  }
+  return alloc_audit_entry{name, 0, 0, 0};
+}
+
+void alloc_audit::reset() noexcept {
+  const auto count = entry_count.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < count; ++i) {
+    entries[i].calls.store(0, std::memory_order_relaxed);
+    entries[i].allocations.store(0, std::memory_order_relaxed);
+    entries[i].bytes.store(0, std::memory_order_relaxed);
+  }
+}
+
+void alloc_audit::report(std::FILE* stream) {
+  std::fprintf(stream, "%-28s %12s %12s %14s\n", "entry point", "calls",
+               "allocations", "bytes");
+  for (const auto& entry : snapshot()) {
+    std::fprintf(stream, "%-28s %12llu %12llu %14llu\n", entry.name,
+                 static_cast<unsigned long long>(entry.calls),
+                 static_cast<unsigned long long>(entry.allocations),
+                 static_cast<unsigned long long>(entry.bytes));
+  }
+}
+
+void* operator new(std::size_t size) {
+  charge(size);
+  if (auto ptr = std::malloc(size != 0 ? size : 1)) return ptr;
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+  charge(size);
+  if (auto ptr = std::malloc(size != 0 ? size : 1)) return ptr;
+  throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  charge(size);
+  return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  charge(size);
+  return std::malloc(size != 0 ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
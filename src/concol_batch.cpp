@@ -0,0 +1,126 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_batch.h"
+
+#include <algorithm>
+
+using namespace concol;
+
+batch_pool::batch_pool(std::size_t threads) {
+  for (std::size_t worker{1}; worker < threads; ++worker) {
+    _threads.emplace_back([this, worker] {
+      std::size_t generation{};
+      std::unique_lock<std::mutex> lock{_mutex};
+      for (;;) {
+        _wake.wait(lock, [&] { return _stop || _generation != generation; });
+        if (_stop) return;
+        generation = _generation;
+        lock.unlock();
+        work(worker);
+        lock.lock();
+        if (--_active == 0) {
+          _done.notify_one();
+        }
+      }
+    });
+  }
+}
+
+batch_pool::~batch_pool() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _stop = true;
+  }
+  _wake.notify_all();
+  for (auto& thread : _threads) {
+    thread.join();
+  }
+}
+
+void batch_pool::work(std::size_t worker) {
+  for (;;) {
+    const auto task = _next.fetch_add(1, std::memory_order_relaxed);
+    if (task >= _tasks) return;
+    try {
+      (*_job)(task, worker);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{_mutex};
+      if (!_error) {
+        _error = std::current_exception();
+      }
+      _next.store(_tasks, std::memory_order_relaxed);
+    }
+  }
+}
+
+void batch_pool::run(std::size_t tasks, const job_type& job) {
+  if (tasks == 0) return;
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _job = &job;
+    _tasks = tasks;
+    _next.store(0, std::memory_order_relaxed);
+    _active = _threads.size();
+    _error = nullptr;
+    ++_generation;
+  }
+  _wake.notify_all();
+  work(0);
+  std::unique_lock<std::mutex> lock{_mutex};
+  _done.wait(lock, [this] { return _active == 0; });
+  _job = nullptr;
+  if (_error) {
+    std::rethrow_exception(_error);
+  }
+}
+
+void detail::render_batch(std::size_t count, const batch_renderer& render,
+                          batch_pool& pool, std::FILE* stream) {
+  const std::size_t workers{pool.size()};
+  const std::size_t chunk{
+      std::max<std::size_t>(64, count / (workers * 16) + 1)};
+  const std::size_t window_chunks{workers * 4};
+  std::vector<std::string> buffers(window_chunks);
+  std::vector<std::string> scratches(workers);
+  for (std::size_t window{}; window < count;
+       window += chunk * window_chunks) {
+    const auto window_end = std::min(count, window + chunk * window_chunks);
+    const auto tasks = (window_end - window + chunk - 1) / chunk;
+    pool.run(tasks, [&](std::size_t task, std::size_t worker) {
+      const auto first = window + task * chunk;
+      const auto last = std::min(window_end, first + chunk);
+      buffers[task].clear();
+      render(first, last, buffers[task], scratches[worker]);
+    });
+    for (std::size_t task{}; task < tasks; ++task) {
+      if (stream == nullptr) {
+        color::write(buffers[task].data(), buffers[task].size());
+      } else {
+        std::fwrite(buffers[task].data(), 1, buffers[task].size(), stream);
+      }
+    }
+  }
+}
@@ -0,0 +1,386 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_binlog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+namespace {
+
+constexpr char binlog_magic[8]{'c', 'o', 'n', 'c', 'o', 'l', 'b', '1'};
+
+constexpr std::size_t align8(std::size_t size) noexcept {
+  return (size + 7) & ~std::size_t(7);
+}
+
+}  // namespace
+
+std::atomic<std::uint32_t> binlog_format::_next{1};
+
+#ifdef _WIN32
+
+binary_log::binary_log([[maybe_unused]] const std::string& path,
+                       [[maybe_unused]] std::size_t capacity) {
+  throw std::system_error(
+      std::make_error_code(std::errc::function_not_supported),
+      "binary_log");
+}
+
+binary_log::~binary_log() {}
+
+void binary_log::flush() noexcept {}
+
+void binary_log::commit(unsigned char* record, std::uint32_t id) noexcept {
+  std::memcpy(record, &id, 4);
+}
+
+#else
+
+binary_log::binary_log(const std::string& path, std::size_t capacity)
+    : _capacity{align8(std::max(capacity, header_size))},
+      _offset{header_size},
+      _defined{new std::atomic<std::uint64_t>[max_formats / 64]{}} {
+  _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (_fd < 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+  void* data{MAP_FAILED};
+  if (::ftruncate(_fd, static_cast<off_t>(_capacity)) == 0) {
+    data = ::mmap(nullptr, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  _fd, 0);
+  }
+  if (data == MAP_FAILED) {
+    const auto error = errno;
+    ::close(_fd);
+    throw std::system_error(error, std::generic_category(), path);
+  }
+  _data = static_cast<unsigned char*>(data);
+  std::memcpy(_data, binlog_magic, sizeof(binlog_magic));
+  const std::uint32_t version{1};
+  std::memcpy(_data + 8, &version, 4);
+}
+
+binary_log::~binary_log() {
+  const auto used = size();
+  ::munmap(_data, _capacity);
+  [[maybe_unused]] const auto result =
+      ::ftruncate(_fd, static_cast<off_t>(used));
+  ::close(_fd);
+}
+
+void binary_log::flush() noexcept { ::msync(_data, size(), MS_ASYNC); }
+
+// The id is stored last: a reader that finds a zero id has reached the end
+// of the completed records, also in a file left behind by a crash.
+void binary_log::commit(unsigned char* record, std::uint32_t id) noexcept {
+  __atomic_store_n(reinterpret_cast<std::uint32_t*>(record), id,
+                   __ATOMIC_RELEASE);
+}
+
+#endif
+
+std::size_t binary_log::size() const noexcept {
+  return std::min(_offset.load(std::memory_order_relaxed), _capacity);
+}
+
+unsigned char* binary_log::reserve(std::size_t size) noexcept {
+  const auto total = align8(8 + size);
+  const auto offset = _offset.fetch_add(total, std::memory_order_relaxed);
+  if (offset + total > _capacity) {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  const auto record = _data + offset;
+  const auto record_size = static_cast<std::uint32_t>(size);
+  std::memcpy(record + 4, &record_size, 4);
+  return record;
+}
+
+bool binary_log::define(std::uint32_t id, const char* signature,
+                        const char* fmt) noexcept {
+  const std::uint64_t bit{std::uint64_t(1) << (id % 64)};
+  if ((_defined[id / 64].fetch_or(bit, std::memory_order_acq_rel) & bit) !=
+      0) {
+    return true;
+  }
+  const auto signature_size = std::strlen(signature) + 1;
+  const auto fmt_size = std::strlen(fmt);
+  const auto record = reserve(signature_size + fmt_size);
+  if (record == nullptr) {
+    _defined[id / 64].fetch_and(~bit, std::memory_order_relaxed);
+    return false;
+  }
+  std::memcpy(record + 8, signature, signature_size);
+  std::memcpy(record + 8 + signature_size, fmt, fmt_size);
+  commit(record, id | define_flag);
+  return true;
+}
+
+namespace {
+
+struct binlog_definition {
+  std::string signature{};
+  std::string parsed{};
+  bool valid{};
+};
+
+template <typename T>
+void append_format(std::string& out, const std::string& spec, T value) {
+  char buffer[128];
+  const auto size = std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+  if (size <= 0) return;
+  if (static_cast<std::size_t>(size) < sizeof(buffer)) {
+    out.append(buffer, static_cast<std::size_t>(size));
+    return;
+  }
+  const auto offset = out.size();
+  out.resize(offset + static_cast<std::size_t>(size));
+  std::snprintf(&out[offset], static_cast<std::size_t>(size) + 1,
+                spec.c_str(), value);
+}
+
+// Raw argument of a data record, converted to whatever the conversion in
+// the format string asks for.
+struct binlog_value {
+  char type{};
+  std::int64_t signed_value{};
+  std::uint64_t unsigned_value{};
+  double double_value{};
+  std::string string_value{};
+};
+
+bool read_value(char type, const unsigned char*& pos,
+                const unsigned char* end, binlog_value& value) {
+  value.type = type;
+  const std::size_t size{(type == 'i' || type == 'u') ? 4u : 8u};
+  if (type == 's') {
+    std::uint32_t length{};
+    if (end - pos < 4) return false;
+    std::memcpy(&length, pos, 4);
+    pos += 4;
+    if (static_cast<std::size_t>(end - pos) < length) return false;
+    value.string_value.assign(reinterpret_cast<const char*>(pos), length);
+    pos += length;
+    return true;
+  }
+  if (static_cast<std::size_t>(end - pos) < size) return false;
+  if (type == 'i') {
+    std::int32_t raw{};
+    std::memcpy(&raw, pos, 4);
+    value.signed_value = raw;
+  } else if (type == 'l') {
+    std::memcpy(&value.signed_value, pos, 8);
+  } else if (type == 'u') {
+    std::uint32_t raw{};
+    std::memcpy(&raw, pos, 4);
+    value.unsigned_value = raw;
+  } else if (type == 'd') {
+    std::memcpy(&value.double_value, pos, 8);
+  } else {
+    std::memcpy(&value.unsigned_value, pos, 8);
+  }
+  pos += size;
+  return true;
+}
+
+std::int64_t as_signed(const binlog_value& value) {
+  switch (value.type) {
+    case 'i':
+    case 'l':
+      return value.signed_value;
+    case 'd':
+      return static_cast<std::int64_t>(value.double_value);
+    case 's':
+      return 0;
+    default:
+      return static_cast<std::int64_t>(value.unsigned_value);
+  }
+}
+
+double as_double(const binlog_value& value) {
+  switch (value.type) {
+    case 'd':
+      return value.double_value;
+    case 'i':
+    case 'l':
+      return static_cast<double>(value.signed_value);
+    case 's':
+      return 0;
+    default:
+      return static_cast<double>(value.unsigned_value);
+  }
+}
+
+// printf with a runtime argument list: the parsed format is split at every
+// conversion, and each one is re-issued with a length modifier matching the
+// decoded value, whatever modifier the call site used.
+void append_record(std::string& out, const binlog_definition& definition,
+                   const unsigned char* pos, const unsigned char* end) {
+  const auto& fmt = definition.parsed;
+  std::size_t arg{};
+  binlog_value value{};
+  std::string spec{};
+  for (std::size_t i = 0; i < fmt.size();) {
+    const auto percent = fmt.find('%', i);
+    if (percent == std::string::npos) {
+      out.append(fmt, i, std::string::npos);
+      break;
+    }
+    out.append(fmt, i, percent - i);
+    auto j = percent + 1;
+    if (j < fmt.size() && fmt[j] == '%') {
+      out += '%';
+      i = j + 1;
+      continue;
+    }
+    spec.assign(1, '%');
+    while (j < fmt.size() && std::strchr("-+ #0'", fmt[j]) != nullptr) {
+      spec += fmt[j++];
+    }
+    std::size_t stars{};
+    while (j < fmt.size() && ((fmt[j] >= '0' && fmt[j] <= '9') ||
+                              fmt[j] == '.' || fmt[j] == '*')) {
+      if (fmt[j] == '*') ++stars;
+      spec += fmt[j++];
+    }
+    while (j < fmt.size() && std::strchr("hlLqjzt", fmt[j]) != nullptr) ++j;
+    if (j == fmt.size() || arg == definition.signature.size() ||
+        !read_value(definition.signature[arg], pos, end, value)) {
+      out.append(fmt, percent, std::string::npos);
+      break;
+    }
+    ++arg;
+    const auto conversion = fmt[j];
+    i = j + 1;
+    // Only conversions with a known argument type reach snprintf: `*`
+    // widths, %n and anything unknown, e.g. from a corrupt or hostile file,
+    // are copied through verbatim and their arguments skipped.
+    if (stars != 0 || conversion == '\0' ||
+        std::strchr("diouxXcspaAeEfFgG", conversion) == nullptr) {
+      out.append(fmt, percent, i - percent);
+      for (; stars != 0 && arg < definition.signature.size(); --stars) {
+        if (!read_value(definition.signature[arg++], pos, end, value)) break;
+      }
+      continue;
+    }
+    switch (conversion) {
+      case 'd':
+      case 'i':
+        spec += "ll";
+        spec += conversion;
+        append_format(out, spec, static_cast<long long>(as_signed(value)));
+        break;
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+        spec += "ll";
+        spec += conversion;
+        append_format(out, spec,
+                      static_cast<unsigned long long>(as_signed(value)));
+        break;
+      case 'c':
+        spec += conversion;
+        append_format(out, spec, static_cast<int>(as_signed(value)));
+        break;
+      case 's':
+        spec += conversion;
+        append_format(out, spec, value.string_value.c_str());
+        break;
+      case 'p':
+        spec += conversion;
+        append_format(out, spec,
+                      reinterpret_cast<void*>(
+                          static_cast<std::uintptr_t>(value.unsigned_value)));
+        break;
+      default:  // aAeEfFgG
+        spec += conversion;
+        append_format(out, spec, as_double(value));
+        break;
+    }
+  }
+}
+
+}  // namespace
+
+void concol::decode_binary_log(const unsigned char* data, std::size_t size,
+                               std::string& out) {
+  if (size < binary_log::header_size ||
+      std::memcmp(data, binlog_magic, sizeof(binlog_magic)) != 0) {
+    throw std::runtime_error("decode_binary_log: not a binary log");
+  }
+  const auto end = data + size;
+  std::vector<binlog_definition> definitions{};
+  // Definitions first: a concurrent writer may commit a message of a new
+  // format before the record defining it.
+  for (int pass = 0; pass < 2; ++pass) {
+    for (auto pos = data + binary_log::header_size; end - pos >= 8;) {
+      std::uint32_t id{}, record_size{};
+      std::memcpy(&id, pos, 4);
+      std::memcpy(&record_size, pos + 4, 4);
+      if (id == 0 && record_size == 0) break;
+      const auto payload = pos + 8;
+      if (static_cast<std::size_t>(end - payload) < record_size) break;
+      pos += align8(8 + record_size);
+      // Reserved but never committed, e.g. by a writer that crashed.
+      if (id == 0) continue;
+      const auto format = id & ~binary_log::define_flag;
+      // Ids the writer never hands out: a corrupt or hostile file.
+      if (format >= binary_log::max_formats) continue;
+      if (pass == 0 && (id & binary_log::define_flag) != 0) {
+        const auto text = reinterpret_cast<const char*>(payload);
+        const auto nul = std::memchr(text, '\0', record_size);
+        if (nul == nullptr) continue;
+        const auto signature_size =
+            static_cast<std::size_t>(static_cast<const char*>(nul) - text);
+        if (definitions.size() <= format) definitions.resize(format + 1);
+        auto& definition = definitions[format];
+        definition.signature.assign(text, signature_size);
+        definition.parsed.clear();
+        color::append_parsed(definition.parsed, text + signature_size + 1,
+                             record_size - signature_size - 1);
+        definition.valid = true;
+      } else if (pass == 1 && (id & binary_log::define_flag) == 0) {
+        if (format < definitions.size() && definitions[format].valid) {
+          append_record(out, definitions[format], payload,
+                        payload + record_size);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,126 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_deferred.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+using namespace concol;
+
+deferred_printer::deferred_printer(std::size_t capacity) {
+  std::size_t size{2};
+  while (size < capacity) size <<= 1;
+  _slots.reset(new slot[size]);
+  _mask = size - 1;
+  for (std::size_t i = 0; i < size; ++i) {
+    _slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+deferred_printer::~deferred_printer() { stop(); }
+
+// Bounded MPMC queue by D. Vyukov, used here with a single consumer: every
+// slot carries a sequence number that tells producers whether it is free
+// for their ticket and the consumer whether it has been published.
+deferred_printer::slot* deferred_printer::claim(std::size_t& pos) noexcept {
+  pos = _enqueue.load(std::memory_order_relaxed);
+  for (;;) {
+    auto s = &_slots[pos & _mask];
+    const auto diff =
+        static_cast<std::intptr_t>(
+            s->sequence.load(std::memory_order_acquire)) -
+        static_cast<std::intptr_t>(pos);
+    if (diff == 0) {
+      if (_enqueue.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+        return s;
+      }
+    } else if (diff < 0) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      pos = _enqueue.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void deferred_printer::append_format(std::string& out, const char* fmt, ...) {
+  thread_local std::string parsed{};
+  parsed.clear();
+  color::append_parsed(parsed, fmt, std::strlen(fmt));
+  std::va_list args;
+  va_start(args, fmt);
+  std::va_list copy;
+  va_copy(copy, args);
+  const auto size = std::vsnprintf(nullptr, 0, parsed.c_str(), copy);
+  va_end(copy);
+  if (size > 0) {
+    const auto offset = out.size();
+    out.resize(offset + static_cast<std::size_t>(size));
+    std::vsnprintf(&out[offset], static_cast<std::size_t>(size) + 1,
+                   parsed.c_str(), args);
+  }
+  va_end(args);
+}
+
+std::size_t deferred_printer::drain() {
+  std::size_t count{};
+  _out.clear();
+  // Bounded, so that sustained producers cannot keep one pass (and _out)
+  // growing without ever reaching the write.
+  for (; count <= _mask; ++count) {
+    auto s = &_slots[_dequeue & _mask];
+    if (s->sequence.load(std::memory_order_acquire) != _dequeue + 1) break;
+    s->render(_out, s->fmt, s->args);
+    s->sequence.store(_dequeue + _mask + 1, std::memory_order_release);
+    ++_dequeue;
+  }
+  if (!_out.empty()) {
+    color::write(_out.data(), _out.size());
+  }
+  return count;
+}
+
+void deferred_printer::start() {
+  if (_running.exchange(true)) return;
+  _thread = std::thread([this] {
+    while (_running.load(std::memory_order_acquire)) {
+      if (drain() == 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds{200});
+      }
+    }
+  });
+}
+
+void deferred_printer::stop() {
+  if (!_running.exchange(false)) return;
+  _thread.join();
+  while (_writers.load() != 0) std::this_thread::yield();
+  while (drain() != 0) {
+  }
+}
@@ -0,0 +1,213 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_emergency.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+namespace {
+
+class fd_buffer final {
+  char _buffer[512];
+  std::size_t _size{};
+  int _fd;
+
+ public:
+  explicit fd_buffer(int fd) noexcept : _fd{fd} {}
+  fd_buffer(const fd_buffer&) = delete;
+  fd_buffer& operator=(const fd_buffer&) = delete;
+  ~fd_buffer() { flush(); }
+
+  void flush() noexcept {
+    const char* pos{_buffer};
+    while (_size != 0) {
+#ifdef _WIN32
+      const auto written = ::_write(_fd, pos, unsigned(_size));
+#else
+      const auto written = ::write(_fd, pos, _size);
+#endif
+      if (written < 0 && errno == EINTR) continue;
+      if (written <= 0) break;
+      pos += written;
+      _size -= std::size_t(written);
+    }
+    _size = 0;
+  }
+  void append(const char* data, std::size_t size) noexcept {
+    while (size != 0) {
+      if (_size == sizeof(_buffer)) flush();
+      const auto chunk =
+          (size < sizeof(_buffer) - _size) ? size : sizeof(_buffer) - _size;
+      std::memcpy(_buffer + _size, data, chunk);
+      _size += chunk;
+      data += chunk;
+      size -= chunk;
+    }
+  }
+  void append(char ch, std::size_t count = 1) noexcept {
+    for (std::size_t i = 0; i < count; ++i) append(&ch, 1);
+  }
+};
+
+// Formats one value right to left into `digits`; returns its length.
+std::size_t format_unsigned(char (&digits)[24], unsigned long long value,
+                            unsigned base, bool upper) noexcept {
+  const char* const symbols{upper ? "0123456789ABCDEF" : "0123456789abcdef"};
+  std::size_t size{};
+  do {
+    digits[sizeof(digits) - 1 - size++] = symbols[value % base];
+    value /= base;
+  } while (value != 0);
+  return size;
+}
+
+void append_padded(fd_buffer& out, const char* data, std::size_t size,
+                   std::size_t width, bool left, char fill) noexcept {
+  const auto padding = (width > size) ? width - size : 0;
+  if (!left) out.append(fill, padding);
+  out.append(data, size);
+  if (left) out.append(' ', padding);
+}
+
+}  // namespace
+
+void concol::emergency_print(int fd, const char* fmt, const emergency_arg* args,
+                             std::size_t count) noexcept {
+  fd_buffer out{fd};
+  std::size_t next{};
+  const bool enabled{color::is_enabled()};
+  for (auto pos = fmt; *pos != '\0';) {
+    const auto special = std::strpbrk(pos, "{%");
+    if (special == nullptr) {
+      out.append(pos, std::strlen(pos));
+      break;
+    }
+    out.append(pos, std::size_t(special - pos));
+    pos = special;
+    if (*pos == '{') {
+      const auto close = std::strchr(pos + 1, '}');
+      const char* escape{};
+      std::size_t escape_size{};
+      if (close != nullptr &&
+          detail::find_tag_escape(pos + 1, std::size_t(close - pos - 1),
+                                  escape, escape_size)) {
+        if (enabled) out.append(escape, escape_size);
+        pos = close + 1;
+      } else {
+        out.append('{');
+        ++pos;
+      }
+      continue;
+    }
+    const char* spec{pos++};
+    bool left{};
+    char fill{' '};
+    for (; *pos == '-' || *pos == '0'; ++pos) {
+      if (*pos == '-') left = true;
+      if (*pos == '0') fill = '0';
+    }
+    std::size_t width{};
+    for (; *pos >= '0' && *pos <= '9'; ++pos) {
+      width = width * 10 + std::size_t(*pos - '0');
+    }
+    while (*pos == 'l' || *pos == 'h' || *pos == 'z' || *pos == 'j') ++pos;
+    const char conversion{*pos};
+    if (conversion == '\0') {
+      out.append(spec, std::strlen(spec));
+      break;
+    }
+    ++pos;
+    if (conversion == '%') {
+      out.append('%');
+      continue;
+    }
+    if (next == count) {
+      out.append(spec, std::size_t(pos - spec));
+      continue;
+    }
+    const auto& arg = args[next++];
+    char digits[24];
+    std::size_t size{};
+    switch (conversion) {
+      case 'd':
+      case 'i': {
+        const auto value = arg.as_signed();
+        const bool negative{arg.type() == emergency_arg::kind::signed_value &&
+                            value < 0};
+        size = format_unsigned(
+            digits,
+            negative ? 0ull - static_cast<unsigned long long>(value)
+                     : static_cast<unsigned long long>(value),
+            10, false);
+        if (negative) {
+          if (fill == '0') {
+            out.append('-');
+            width = (width != 0) ? width - 1 : 0;
+          } else {
+            digits[sizeof(digits) - 1 - size++] = '-';
+          }
+        }
+        break;
+      }
+      case 'u':
+        size = format_unsigned(digits, arg.as_unsigned(), 10, false);
+        break;
+      case 'x':
+      case 'X':
+        size = format_unsigned(digits, arg.as_unsigned(), 16,
+                               conversion == 'X');
+        break;
+      case 'p':
+        size = format_unsigned(digits, arg.as_unsigned(), 16, false);
+        digits[sizeof(digits) - 1 - size++] = 'x';
+        digits[sizeof(digits) - 1 - size++] = '0';
+        break;
+      case 'c':
+        digits[sizeof(digits) - 1] = char(arg.as_signed());
+        size = 1;
+        break;
+      case 's': {
+        const auto str = arg.as_string();
+        const auto text = (str != nullptr) ? str : "(null)";
+        append_padded(out, text, std::strlen(text), width, left, ' ');
+        continue;
+      }
+      default:
+        out.append(spec, std::size_t(pos - spec));
+        continue;
+    }
+    append_padded(out, digits + sizeof(digits) - size, size, width, left,
+                  left ? ' ' : fill);
+  }
+}
@@ -0,0 +1,210 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_hexdump.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "concol_simd.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr char hex_digits[]{"0123456789abcdef"};
+
+byte_class default_class(unsigned byte) noexcept {
+  if (byte == 0) return byte_class::zero;
+  if (byte >= 0x20 && byte < 0x7F) return byte_class::printable;
+  if (byte < 0x80) return byte_class::control;
+  return byte_class::high;
+}
+
+char display_char(unsigned char byte) noexcept {
+  return (byte >= 0x20 && byte < 0x7F) ? char(byte) : '.';
+}
+
+// Escapes longer than a slot (several tags in one style) are rare enough to
+// be copied separately.
+char* copy_transition(char* out, const std::string& escape,
+                      bool change) noexcept {
+  if (!change) return out;
+  std::memcpy(out, escape.data(), escape.size());
+  return out + escape.size();
+}
+
+}  // namespace
+
+hexdump_renderer::hexdump_renderer(const hexdump_styles& styles) {
+  const std::string* tags[class_count]{&styles.zero, &styles.printable,
+                                       &styles.control, &styles.high};
+  _transitions[plain] = color::ansi_color_reset();
+  for (std::size_t i{}; i < class_count; ++i) {
+    color::append_parsed(_transitions[i], tags[i]->data(), tags[i]->size());
+  }
+  std::size_t max_transition{};
+  for (std::size_t i{}; i <= class_count; ++i) {
+    _transition_sizes[i] = _transitions[i].size();
+    max_transition = std::max(max_transition, _transition_sizes[i]);
+    if (_transitions[i].size() < slot_size) _transitions[i].resize(slot_size);
+  }
+  for (unsigned byte{}; byte < 256; ++byte) {
+    set_class(static_cast<unsigned char>(byte), default_class(byte));
+  }
+  // 16 offset digits, both columns with their separators, a transition
+  // before every byte of both columns plus one closing each, and the
+  // padding of the last slot.
+  _line_size = 16 + 2 + bytes_per_line * 3 + 1 + 2 + bytes_per_line + 2 +
+               2 * (bytes_per_line + 1) * max_transition + slot_size;
+  _scratch.reset(new char[block_lines * _line_size]);
+}
+
+void hexdump_renderer::set_class(unsigned char byte, byte_class cls) noexcept {
+  const auto index = static_cast<unsigned char>(cls);
+  _classes[byte] = index;
+  _styles[byte] = (_transition_sizes[index] != 0) ? index : plain;
+}
+
+// Branch-free for escapes that fit a slot: random data changes class at
+// almost every byte, which a conditional copy would mispredict.
+char* hexdump_renderer::transition(char* out, unsigned char style,
+                                   bool change) const noexcept {
+  const auto size = _transition_sizes[style];
+  if (size > slot_size) {
+    return copy_transition(out, _transitions[style], change);
+  }
+  std::memcpy(out, _transitions[style].data(), slot_size);
+  return out + (change ? size : 0);
+}
+
+char* hexdump_renderer::render_line(const unsigned char* data,
+                                    std::size_t size, std::uint64_t offset,
+                                    unsigned offset_digits,
+                                    char* out) const noexcept {
+  for (auto i = offset_digits; i-- != 0; offset >>= 4) {
+    out[i] = hex_digits[offset & 0x0F];
+  }
+  out += offset_digits;
+  *out++ = ' ';
+  *out++ = ' ';
+
+  unsigned char tail[bytes_per_line]{};
+  if (size < bytes_per_line) {
+    std::memcpy(tail, data, size);
+    data = tail;
+  }
+  char hex[2 * bytes_per_line];
+  detail::hex_digits16(data, hex);
+
+  // Lines of one style (text, zero padding) take a single transition per
+  // column; mixed lines go through the branch-free path for every byte.
+  unsigned char styles[bytes_per_line]{};
+  bool uniform{true};
+  for (std::size_t i{}; i < size; ++i) {
+    styles[i] = _styles[data[i]];
+    uniform = uniform && styles[i] == styles[0];
+  }
+
+  unsigned char current{plain};
+  if (uniform) {
+    out = transition(out, styles[0], styles[0] != plain);
+    current = styles[0];
+    for (std::size_t i{}; i < size; ++i) {
+      out[0] = hex[2 * i];
+      out[1] = hex[2 * i + 1];
+      out[2] = ' ';
+      out += 3;
+      if (i == bytes_per_line / 2 - 1) *out++ = ' ';
+    }
+  } else {
+    for (std::size_t i{}; i < size; ++i) {
+      out = transition(out, styles[i], styles[i] != current);
+      current = styles[i];
+      out[0] = hex[2 * i];
+      out[1] = hex[2 * i + 1];
+      out[2] = ' ';
+      out += 3;
+      if (i == bytes_per_line / 2 - 1) *out++ = ' ';
+    }
+  }
+  out = transition(out, plain, current != plain);
+  for (auto i = size; i < bytes_per_line; ++i) {
+    std::memcpy(out, "   ", 3);
+    out += 3;
+    if (i == bytes_per_line / 2 - 1) *out++ = ' ';
+  }
+  *out++ = ' ';
+  *out++ = '|';
+
+  current = plain;
+  if (uniform) {
+    out = transition(out, styles[0], styles[0] != plain);
+    current = styles[0];
+    for (std::size_t i{}; i < size; ++i) *out++ = display_char(data[i]);
+  } else {
+    for (std::size_t i{}; i < size; ++i) {
+      out = transition(out, styles[i], styles[i] != current);
+      current = styles[i];
+      *out++ = display_char(data[i]);
+    }
+  }
+  out = transition(out, plain, current != plain);
+  *out++ = '|';
+  *out++ = '\n';
+  return out;
+}
+
+void hexdump_renderer::render(const void* data, std::size_t size,
+                              std::string& out, std::uint64_t offset) {
+  CONCOL_AUDIT_SCOPE("hexdump_renderer::render");
+  auto pos = static_cast<const unsigned char*>(data);
+  const auto end = pos + size;
+  while (pos != end) {
+    char* stop{_scratch.get()};
+    for (std::size_t line{}; line < block_lines && pos != end; ++line) {
+      const auto count = std::min(bytes_per_line, std::size_t(end - pos));
+      const unsigned offset_digits{(offset > 0xFFFFFFFFu) ? 16u : 8u};
+      stop = render_line(pos, count, offset, offset_digits, stop);
+      pos += count;
+      offset += count;
+    }
+    out.append(_scratch.get(), stop);
+  }
+}
+
+void concol::print_hexdump(const void* data, std::size_t size,
+                           std::uint64_t offset) {
+  constexpr std::size_t block{64 * 1024};
+  hexdump_renderer renderer{};
+  std::string out{};
+  const auto bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t done{}; done < size; done += block) {
+    out.clear();
+    renderer.render(bytes + done, std::min(block, size - done), out,
+                    offset + done);
+    color::write(out.data(), out.size());
+  }
+}
@@ -0,0 +1,586 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_highlight.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "concol_simd.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+namespace {
+
+constexpr std::size_t max_key{16};
+constexpr unsigned max_depth{64};
+// Input is highlighted this much at a time, which bounds the scratch output.
+constexpr std::size_t slice_size{16 * 1024};
+
+const std::size_t reset_size{std::strlen(color::ansi_color_reset())};
+
+bool is_space(char ch) noexcept {
+  return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+bool is_digit(char ch) noexcept { return ch >= '0' && ch <= '9'; }
+
+bool is_json_delimiter(char ch) noexcept {
+  switch (ch) {
+    case ',':
+    case '}':
+    case ']':
+    case ':':
+    case '"':
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool is_level_key(std::string_view key) noexcept {
+  return key == "level" || key == "lvl" || key == "severity" ||
+         key == "loglevel" || key == "levelname";
+}
+
+bool starts_with_word(std::string_view value, std::string_view word) noexcept {
+  if (value.size() < word.size()) return false;
+  for (std::size_t i = 0; i < word.size(); ++i) {
+    if ((value[i] | 0x20) != word[i]) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+structured_highlighter::style structured_highlighter::bare_style(
+    std::string_view token) noexcept {
+  if (token == "true" || token == "false" || token == "null") return literal;
+  const std::size_t sign{(!token.empty() && token[0] == '-') ? 1u : 0u};
+  if (token.size() <= sign || !is_digit(token[sign])) return none;
+  // Signs only after an exponent, so that dates stay plain.
+  for (auto i = sign + 1; i < token.size(); ++i) {
+    const auto ch = token[i];
+    if (is_digit(ch) || ch == '.' || ch == 'e' || ch == 'E') continue;
+    if ((ch == '+' || ch == '-') && (token[i - 1] | 0x20) == 'e') continue;
+    return none;
+  }
+  return number;
+}
+
+// Level names as used by common loggers, and the numeric levels of pino
+// and bunyan (10 trace ... 60 fatal).
+structured_highlighter::style structured_highlighter::level_style(
+    std::string_view value, style fallback) noexcept {
+  if (value.size() == 2 && is_digit(value[0]) && is_digit(value[1])) {
+    const auto level = (value[0] - '0') * 10 + (value[1] - '0');
+    if (level >= 50) return error;
+    if (level >= 40) return warning;
+    if (level >= 30) return info;
+    return debug;
+  }
+  for (const auto word : {"err", "fatal", "crit", "panic", "emerg", "alert"}) {
+    if (starts_with_word(value, word)) return error;
+  }
+  if (starts_with_word(value, "warn")) return warning;
+  if (starts_with_word(value, "info") || starts_with_word(value, "notice")) {
+    return info;
+  }
+  if (starts_with_word(value, "debug") || starts_with_word(value, "trace")) {
+    return debug;
+  }
+  return fallback;
+}
+
+structured_highlighter::style structured_highlighter::first_style(
+    char ch) noexcept {
+  if (ch == '-' || is_digit(ch)) return number;
+  if (ch == 't' || ch == 'f' || ch == 'n') return literal;
+  return none;
+}
+
+// Style of a whole deferred token; a logfmt word is a key only when '='
+// ends it, which emit_token() checks.
+structured_highlighter::style structured_highlighter::token_style(
+    std::string_view text) const noexcept {
+  switch (_token) {
+    case token::word:
+      return none;
+    case token::bare: {
+      const auto s = bare_style(text);
+      return _level_key ? level_style(text, s) : s;
+    }
+    case token::json_bare:
+      return level_style(text, text.empty() ? none : first_style(text[0]));
+    case token::quoted:
+      // Without the opening quote; the closing one is never part of `text`.
+      return level_style(text.substr(text.empty() ? 0 : 1), string);
+  }
+  return none;
+}
+
+structured_highlighter::structured_highlighter(highlight_format format,
+                                               const highlight_styles& styles)
+    : _format{format} {
+  const std::string* tags[style_count]{
+      nullptr,        &styles.key,   &styles.string,
+      &styles.number, &styles.literal, &styles.error,
+      &styles.warning, &styles.info,  &styles.debug};
+  for (int i = key; i < style_count; ++i) {
+    color::append_parsed(_escapes[i], tags[i]->data(), tags[i]->size());
+    _max_escape = std::max(_max_escape, _escapes[i].size());
+  }
+  _pending.reserve(max_pending + 64);
+}
+
+// Every input byte is written once and starts at most one token (an escape
+// and a reset); a held back token is written on top of that.
+void structured_highlighter::reserve(std::size_t input_size) {
+  const auto per_byte = _max_escape + reset_size + 1;
+  const auto bound = (input_size + 1) * per_byte + _pending.size();
+  if (_scratch_size < bound) {
+    _scratch.reset(new char[bound]);
+    _scratch_size = bound;
+  }
+  _out = _scratch.get();
+}
+
+void structured_highlighter::open(style s) noexcept {
+  const auto& escape = _escapes[s];
+  if (escape.empty()) return;
+  put(escape.data(), escape.size());
+  _styled = true;
+}
+
+void structured_highlighter::close() noexcept {
+  if (!_styled) return;
+  put(color::ansi_color_reset(), reset_size);
+  _styled = false;
+}
+
+void structured_highlighter::end_line() noexcept {
+  _state = state::line_start;
+  _containers = 0;
+  _depth = 0;
+  _expect_key = false;
+  _is_key = false;
+  _escaped = false;
+  _level_key = false;
+}
+
+bool structured_highlighter::in_object() const noexcept {
+  return _depth != 0 && _depth <= max_depth &&
+         ((_containers >> (_depth - 1)) & 1) != 0;
+}
+
+void structured_highlighter::feed(std::string_view chunk, std::string& out) {
+  CONCOL_AUDIT_SCOPE("structured_highlighter::feed");
+  const char* pos{chunk.data()};
+  const char* const chunk_end{pos + chunk.size()};
+  while (pos != chunk_end) {
+    const char* const end{
+        pos + std::min(slice_size, std::size_t(chunk_end - pos))};
+    reserve(std::size_t(end - pos));
+    while (pos != end) {
+      switch (_state) {
+        case state::line_start:
+          pos = line_start(pos, end);
+          break;
+        case state::json:
+          pos = json(pos, end);
+          break;
+        case state::json_bare:
+          pos = json_bare(pos, end);
+          break;
+        case state::string:
+          pos = quoted(pos, end);
+          break;
+        case state::logfmt:
+          pos = logfmt(pos, end);
+          break;
+        case state::logfmt_value:
+          pos = logfmt_value(pos, end);
+          break;
+        case state::plain_word:
+          pos = plain_word(pos, end);
+          break;
+        case state::deferred:
+          pos = deferred(pos, end);
+          break;
+      }
+    }
+    out.append(_scratch.get(), _out);
+  }
+}
+
+void structured_highlighter::finish(std::string& out) {
+  reserve(0);
+  if (_state == state::deferred) {
+    open(token_style(_pending));
+    put(_pending.data(), _pending.size());
+    _pending.clear();
+  }
+  close();
+  end_line();
+  out.append(_scratch.get(), _out);
+}
+
+// Where the current deferred token ends: its delimiter, or the closing
+// quote or newline of a string; nullptr when the slice ends first.
+const char* structured_highlighter::token_end(const char* pos,
+                                              const char* end) noexcept {
+  const char* stop{end};
+  switch (_token) {
+    case token::word:
+      stop = detail::find_any_of(pos, end, ' ', '=', '\n', '\t');
+      break;
+    case token::bare:
+      stop = detail::find_any_of(pos, end, ' ', '\t', '\n', '\r');
+      break;
+    case token::json_bare:
+      stop = pos;
+      while (stop != end && !is_json_delimiter(*stop)) ++stop;
+      break;
+    case token::quoted:
+      while (pos != end) {
+        if (_escaped) {
+          _escaped = false;
+          ++pos;
+          continue;
+        }
+        stop = detail::find_any_of(pos, end, '"', '\\', '\n', '"');
+        if (stop == end || *stop != '\\') break;
+        _escaped = true;
+        pos = stop + 1;
+      }
+      if (pos == end) stop = end;
+      break;
+  }
+  return (stop == end) ? nullptr : stop;
+}
+
+// Tokens that end within the slice are styled and written right away; only
+// one cut by the end of the slice is held back.
+const char* structured_highlighter::start_token(token kind, const char* pos,
+                                                const char* end) {
+  _token = kind;
+  _escaped = false;
+  const char* stop{token_end((kind == token::quoted) ? pos + 1 : pos, end)};
+  if (stop != nullptr) return emit_token(pos, stop, stop);
+  _pending.assign(pos, end);
+  _state = state::deferred;
+  if (_pending.size() > max_pending) overflow();
+  return end;
+}
+
+const char* structured_highlighter::deferred(const char* pos,
+                                             const char* end) {
+  const char* stop{token_end(pos, end)};
+  if (stop == nullptr) {
+    _pending.append(pos, end);
+    if (_pending.size() > max_pending) overflow();
+    return end;
+  }
+  _pending.append(pos, stop);
+  const auto next = emit_token(_pending.data(),
+                               _pending.data() + _pending.size(), stop);
+  _pending.clear();
+  return next;
+}
+
+// Writes the token [pos, stop) ended by `*term` and returns where the slice
+// continues.
+const char* structured_highlighter::emit_token(const char* pos,
+                                               const char* stop,
+                                               const char* term) {
+  const std::string_view text{pos, std::size_t(stop - pos)};
+  if (_token == token::word) {
+    if (*term != '=') {
+      put(text.data(), text.size());
+      _state = state::logfmt;
+      return term;
+    }
+    _level_key = is_level_key(text);
+    open(key);
+    put(text.data(), text.size());
+    close();
+    put('=');
+    _state = state::logfmt_value;
+    return term + 1;
+  }
+  open(token_style(text));
+  put(text.data(), text.size());
+  _level_key = false;
+  if (_token != token::quoted) {
+    close();
+    _state = (_token == token::json_bare) ? state::json : state::logfmt;
+    return term;
+  }
+  if (*term == '"') {
+    put('"');
+    close();
+    _state = _after;
+    return term + 1;
+  }
+  // A line cut inside a string: the next line starts afresh.
+  close();
+  put('\n');
+  end_line();
+  return term + 1;
+}
+
+// A held back token grew too long: it is written with its fallback style
+// and the rest streams through.
+void structured_highlighter::overflow() {
+  switch (_token) {
+    case token::word:
+    case token::bare:
+      _state = state::plain_word;
+      break;
+    case token::json_bare:
+      open(first_style(_pending[0]));
+      _state = state::json_bare;
+      break;
+    case token::quoted:
+      open(string);
+      _is_key = false;
+      _state = state::string;
+      break;
+  }
+  put(_pending.data(), _pending.size());
+  _pending.clear();
+  _level_key = false;
+}
+
+const char* structured_highlighter::line_start(const char* pos,
+                                               const char* end) noexcept {
+  while (pos != end && (is_space(*pos) || *pos == '\n')) put(*pos++);
+  if (pos == end) return pos;
+  const bool json{_format == highlight_format::json ||
+                  (_format == highlight_format::automatic &&
+                   (*pos == '{' || *pos == '['))};
+  _state = json ? state::json : state::logfmt;
+  return pos;
+}
+
+// Outside strings: containers, punctuation and whitespace, one byte at a
+// time, until the next token starts.
+const char* structured_highlighter::json(const char* pos, const char* end) {
+  for (; pos != end; ++pos) {
+    const char ch{*pos};
+    switch (ch) {
+      case '"':
+        _is_key = _expect_key && in_object();
+        _after = state::json;
+        if (_level_key && !_is_key) return start_token(token::quoted, pos, end);
+        if (_is_key) _key.clear();
+        open(_is_key ? key : string);
+        put(ch);
+        _escaped = false;
+        _state = state::string;
+        return pos + 1;
+      case '{':
+      case '[':
+        if (_depth < max_depth) {
+          const auto bit = std::uint64_t(1) << _depth;
+          _containers = (ch == '{') ? (_containers | bit) : (_containers & ~bit);
+        }
+        ++_depth;
+        _expect_key = ch == '{';
+        _level_key = false;
+        break;
+      case '}':
+      case ']':
+        if (_depth != 0) --_depth;
+        _expect_key = false;
+        _level_key = false;
+        break;
+      case ':':
+        _expect_key = false;
+        break;
+      case ',':
+        _expect_key = in_object();
+        _level_key = false;
+        break;
+      case '\n':
+        if (_depth != 0) break;
+        put(ch);
+        end_line();
+        return pos + 1;
+      case ' ':
+      case '\t':
+      case '\r':
+        break;
+      default:
+        if (_level_key) return start_token(token::json_bare, pos, end);
+        open(first_style(ch));
+        _state = state::json_bare;
+        return pos;
+    }
+    put(ch);
+  }
+  return pos;
+}
+
+const char* structured_highlighter::json_bare(const char* pos,
+                                              const char* end) noexcept {
+  const char* stop{pos};
+  while (stop != end && !is_json_delimiter(*stop)) ++stop;
+  put(pos, std::size_t(stop - pos));
+  if (stop == end) return stop;
+  close();
+  _level_key = false;
+  _state = state::json;
+  return stop;
+}
+
+// Body of a string whose style is already open, skipped with a SIMD scan
+// for quotes, backslashes and newlines.
+const char* structured_highlighter::quoted(const char* pos, const char* end) {
+  while (pos != end) {
+    if (_escaped) {
+      if (_is_key && _key.size() < max_key) _key += *pos;
+      put(*pos++);
+      _escaped = false;
+      continue;
+    }
+    const char* stop{detail::find_any_of(pos, end, '"', '\\', '\n', '"')};
+    if (_is_key && _key.size() < max_key) {
+      _key.append(pos, std::min(stop, pos + (max_key - _key.size())));
+    }
+    put(pos, std::size_t(stop - pos));
+    pos = stop;
+    if (pos == end) break;
+    if (*pos == '\\') {
+      put(*pos++);
+      _escaped = true;
+      continue;
+    }
+    if (*pos == '\n') {
+      close();
+      put('\n');
+      end_line();
+      return pos + 1;
+    }
+    put('"');
+    close();
+    _level_key = _is_key && is_level_key(_key);
+    _is_key = false;
+    _state = _after;
+    return pos + 1;
+  }
+  return pos;
+}
+
+const char* structured_highlighter::logfmt(const char* pos, const char* end) {
+  for (; pos != end; ++pos) {
+    const char ch{*pos};
+    if (ch == '\n') {
+      put(ch);
+      end_line();
+      return pos + 1;
+    }
+    if (is_space(ch)) {
+      put(ch);
+      continue;
+    }
+    if (ch == '"') {
+      open(string);
+      put(ch);
+      _is_key = false;
+      _escaped = false;
+      _after = state::logfmt;
+      _state = state::string;
+      return pos + 1;
+    }
+    // Key or plain word: decided by what ends it.
+    return start_token(token::word, pos, end);
+  }
+  return pos;
+}
+
+const char* structured_highlighter::logfmt_value(const char* pos,
+                                                 const char* end) {
+  const char ch{*pos};
+  _after = state::logfmt;
+  if (ch == '"') {
+    if (_level_key) return start_token(token::quoted, pos, end);
+    open(string);
+    put(ch);
+    _is_key = false;
+    _escaped = false;
+    _state = state::string;
+    return pos + 1;
+  }
+  if (is_space(ch) || ch == '\n') {
+    _level_key = false;
+    _state = state::logfmt;
+    return pos;
+  }
+  return start_token(token::bare, pos, end);
+}
+
+const char* structured_highlighter::plain_word(const char* pos,
+                                               const char* end) noexcept {
+  const char* stop{detail::find_any_of(pos, end, ' ', '\t', '\n', '\r')};
+  put(pos, std::size_t(stop - pos));
+  if (stop != end) _state = state::logfmt;
+  return stop;
+}
+
+void concol::highlight_stream(std::FILE* in, std::FILE* out,
+                              highlight_format format) {
+  structured_highlighter highlighter{format};
+  std::vector<char> buffer(64 * 1024);
+  std::string colored{};
+  colored.reserve(buffer.size() * 2);
+  for (;;) {
+#ifndef _WIN32
+    // read(2) returns what a pipe has instead of waiting for a full buffer.
+    std::fflush(out);
+    const auto result = ::read(fileno(in), buffer.data(), buffer.size());
+    if (result <= 0) break;
+    const auto size = std::size_t(result);
+#else
+    const auto size = std::fread(buffer.data(), 1, buffer.size(), in);
+    if (size == 0) break;
+#endif
+    colored.clear();
+    highlighter.feed(std::string_view{buffer.data(), size}, colored);
+    std::fwrite(colored.data(), 1, colored.size(), out);
+  }
+  colored.clear();
+  highlighter.finish(colored);
+  std::fwrite(colored.data(), 1, colored.size(), out);
+  std::fflush(out);
+}
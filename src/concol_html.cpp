@@ -0,0 +1,259 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_html.h"
+
+#include <cstring>
+#include <vector>
+
+#include "concol_simd.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr const char* const fg_classes[]{
+    "cc-fg-black", "cc-fg-red",     "cc-fg-green", "cc-fg-yellow",
+    "cc-fg-blue",  "cc-fg-magenta", "cc-fg-cyan",  "cc-fg-white"};
+constexpr const char* const bg_classes[]{
+    "cc-bg-black", "cc-bg-red",     "cc-bg-green", "cc-bg-yellow",
+    "cc-bg-blue",  "cc-bg-magenta", "cc-bg-cyan",  "cc-bg-white"};
+
+// color_type is in console order, the SGR palette in ANSI order.
+signed char ansi_index(color_type color) noexcept {
+  constexpr signed char index[]{0, 4, 2, 6, 1, 5, 3, 7};
+  return (color == color_type::none) ? -1 : index[int(color) & 7];
+}
+
+struct html_escapes {
+  const char* table[256]{};
+  html_escapes() noexcept {
+    table[static_cast<unsigned char>('&')] = "&amp;";
+    table[static_cast<unsigned char>('<')] = "&lt;";
+    table[static_cast<unsigned char>('>')] = "&gt;";
+    table[static_cast<unsigned char>('"')] = "&quot;";
+  }
+};
+
+const html_escapes escapes{};
+
+}  // namespace
+
+std::size_t html_converter::sequence_size(const char* pos,
+                                          const char* end) const noexcept {
+  if (_format == text_format::ansi) {
+    return detail::ansi_sequence_size(pos, end);
+  }
+  const auto size = std::size_t(end - pos);
+  const auto limit = (size < max_pending) ? size : max_pending;
+  const auto close = static_cast<const char*>(std::memchr(pos, '}', limit));
+  if (close != nullptr) return std::size_t(close - pos + 1);
+  // Too long to be a tag: the brace is plain text.
+  return (size < max_pending) ? 0 : 1;
+}
+
+void html_converter::apply(const char* pos, std::size_t size,
+                           std::string& out) {
+  if (_format == text_format::ansi) {
+    if (size > 2 && pos[1] == '[' && pos[size - 1] == 'm') {
+      apply_sgr(pos + 2, pos + size - 1);
+    }
+    return;
+  }
+  color_type fg{};
+  if (size >= 2 && detail::find_color_tag(pos + 1, size - 2, fg)) {
+    _current = style{ansi_index(fg), -1, int(fg) > int(color_type::white)};
+  } else if (const auto themed =
+                 (size >= 2) ? detail::find_theme_tag(pos + 1, size - 2)
+                             : nullptr) {
+    _current = style{ansi_index(themed->fg), ansi_index(themed->bg),
+                     int(themed->fg) > int(color_type::white)};
+  } else {
+    append_text(pos, pos + size, out);
+  }
+}
+
+void html_converter::apply_sgr(const char* pos, const char* end) noexcept {
+  int params[16];
+  std::size_t count{};
+  int value{};
+  for (; pos != end; ++pos) {
+    if (*pos >= '0' && *pos <= '9') {
+      value = value * 10 + (*pos - '0');
+    } else if (*pos == ';' || *pos == ':') {
+      if (count < 16) params[count++] = value;
+      value = 0;
+    } else {
+      return;
+    }
+  }
+  if (count < 16) params[count++] = value;
+  for (std::size_t i{}; i < count; ++i) {
+    const auto param = params[i];
+    if (param == 0) {
+      _current = style{};
+    } else if (param == 1) {
+      _current.bold = true;
+    } else if (param == 22) {
+      _current.bold = false;
+    } else if (param >= 30 && param <= 37) {
+      _current.fg = static_cast<signed char>(param - 30);
+    } else if (param == 39) {
+      _current.fg = -1;
+    } else if (param >= 40 && param <= 47) {
+      _current.bg = static_cast<signed char>(param - 40);
+    } else if (param == 49) {
+      _current.bg = -1;
+    } else if (param >= 90 && param <= 97) {
+      _current.fg = static_cast<signed char>(param - 90);
+      _current.bold = true;
+    } else if (param >= 100 && param <= 107) {
+      _current.bg = static_cast<signed char>(param - 100);
+    } else if (param == 38 || param == 48) {
+      // 256-color and RGB forms have no class; skip their arguments.
+      if (i + 1 < count) i += (params[i + 1] == 5) ? 2 : 4;
+    }
+  }
+}
+
+void html_converter::close_span(std::string& out) {
+  if (_open != style{}) out += "</span>";
+  _open = style{};
+}
+
+void html_converter::append_text(const char* pos, const char* end,
+                                 std::string& out) {
+  if (pos == end) return;
+  if (_current != _open) {
+    close_span(out);
+    if (_current != style{}) {
+      out += "<span class=\"";
+      const char* separator{""};
+      if (_current.fg >= 0) {
+        out += fg_classes[_current.fg];
+        separator = " ";
+      }
+      if (_current.bg >= 0) {
+        out += separator;
+        out += bg_classes[_current.bg];
+        separator = " ";
+      }
+      if (_current.bold) {
+        out += separator;
+        out += "cc-bold";
+      }
+      out += "\">";
+      _open = _current;
+    }
+  }
+  while (pos != end) {
+    auto run = pos;
+    while (run != end &&
+           escapes.table[static_cast<unsigned char>(*run)] == nullptr) {
+      ++run;
+    }
+    out.append(pos, run);
+    if (run == end) break;
+    out += escapes.table[static_cast<unsigned char>(*run)];
+    pos = run + 1;
+  }
+}
+
+void html_converter::feed(std::string_view chunk, std::string& out) {
+  CONCOL_AUDIT_SCOPE("html_converter::feed");
+  const char* pos{chunk.data()};
+  const char* const end{pos + chunk.size()};
+  while (!_pending.empty() && pos != end) {
+    _pending += *pos++;
+    const auto size =
+        sequence_size(_pending.data(), _pending.data() + _pending.size());
+    if (size != 0) {
+      apply(_pending.data(), size, out);
+      // A literal brace leaves the rest of the carried bytes to rescan.
+      const std::string rest{_pending, size};
+      _pending.clear();
+      feed(rest, out);
+    } else if (_pending.size() >= max_pending) {
+      _pending.clear();
+    }
+  }
+  const char special{(_format == text_format::markup) ? '{' : '\x1b'};
+  while (pos != end) {
+    const auto stop = detail::find_byte(pos, end, special);
+    append_text(pos, stop, out);
+    pos = stop;
+    if (pos == end) break;
+    const auto size = sequence_size(pos, end);
+    if (size == 0) {
+      _pending.assign(pos, end);
+      break;
+    }
+    apply(pos, size, out);
+    pos += size;
+  }
+}
+
+void html_converter::finish(std::string& out) {
+  if (_format == text_format::markup) {
+    append_text(_pending.data(), _pending.data() + _pending.size(), out);
+  }
+  _pending.clear();
+  close_span(out);
+  _current = style{};
+}
+
+const char* html_converter::stylesheet() noexcept {
+  return ".cc-fg-black{color:#000}.cc-fg-red{color:#c00}"
+         ".cc-fg-green{color:#0a0}.cc-fg-yellow{color:#a60}"
+         ".cc-fg-blue{color:#00c}.cc-fg-magenta{color:#a0a}"
+         ".cc-fg-cyan{color:#0aa}.cc-fg-white{color:#aaa}"
+         ".cc-bg-black{background:#000}.cc-bg-red{background:#c00}"
+         ".cc-bg-green{background:#0a0}.cc-bg-yellow{background:#a60}"
+         ".cc-bg-blue{background:#00c}.cc-bg-magenta{background:#a0a}"
+         ".cc-bg-cyan{background:#0aa}.cc-bg-white{background:#aaa}"
+         ".cc-bold{font-weight:bold;filter:brightness(1.3)}";
+}
+
+void concol::write_html(std::FILE* in, std::FILE* out, text_format format) {
+  std::fprintf(out,
+               "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">"
+               "<style>%s</style></head><body><pre>",
+               html_converter::stylesheet());
+  html_converter converter{format};
+  std::vector<char> buffer(64 * 1024);
+  std::string html{};
+  html.reserve(buffer.size() * 2);
+  for (;;) {
+    const auto size = std::fread(buffer.data(), 1, buffer.size(), in);
+    if (size == 0) break;
+    html.clear();
+    converter.feed(std::string_view{buffer.data(), size}, html);
+    std::fwrite(html.data(), 1, html.size(), out);
+  }
+  html.clear();
+  converter.finish(html);
+  html += "</pre></body></html>\n";
+  std::fwrite(html.data(), 1, html.size(), out);
+}
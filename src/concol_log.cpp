@@ -0,0 +1,81 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_log.h"
+
+using namespace concol;
+
+std::atomic<int> logger::_level{int(log_level::trace)};
+std::atomic<bool> logger::_timestamp{};
+
+namespace {
+
+struct level_style {
+  const char* name;
+  color_type fg;
+};
+
+constexpr level_style level_styles[]{{"TRACE", color_type::black_bright},
+                                     {"DEBUG", color_type::cyan},
+                                     {"INFO ", color_type::green_bright},
+                                     {"WARN ", color_type::yellow_bright},
+                                     {"ERROR", color_type::red_bright}};
+
+// Rendered once: [0] without colors, [1] with colors.
+struct level_prefixes {
+  std::string values[2][5];
+
+  level_prefixes() {
+    for (int level{}; level < 5; ++level) {
+      const auto& style = level_styles[level];
+      values[0][level] = std::string{style.name} + ' ';
+      values[1][level] = color::ansi_color_code(style.fg) + style.name +
+                         color::ansi_color_reset() + ' ';
+    }
+  }
+};
+
+const level_prefixes& prefixes() {
+  static const level_prefixes instance{};
+  return instance;
+}
+
+}  // namespace
+
+void logger::append_prefix(log_level level, std::string& line) {
+  if (level >= log_level::off) return;
+  line += prefixes().values[color::is_enabled() ? 1 : 0][int(level)];
+}
+
+const char* logger::prefix_markup(log_level level) noexcept {
+  static const char* const markup[]{"{+black}TRACE{} ", "{cyan}DEBUG{} ",
+                                    "{+green}INFO {} ", "{+yellow}WARN {} ",
+                                    "{+red}ERROR{} "};
+  return (level < log_level::off) ? markup[int(level)] : "";
+}
+
+void logger::write(const std::string& line) {
+  color::write(line.data(), line.size());
+}
@@ -0,0 +1,244 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_mmap.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+// Zero words are skipped eight bytes at a time once the scan is aligned.
+std::size_t detail::recover_length(const char* data,
+                                   std::size_t size) noexcept {
+  auto end = size;
+  while (end != 0 && end % 8 != 0 && data[end - 1] == '\0') --end;
+  for (; end >= 8; end -= 8) {
+    std::uint64_t word{};
+    std::memcpy(&word, data + end - 8, sizeof(word));
+    if (word != 0) break;
+  }
+  while (end != 0 && data[end - 1] == '\0') --end;
+  return end;
+}
+
+#ifndef _WIN32
+
+namespace {
+
+// Extends the file to `size` with its blocks allocated; returns an errno
+// value. Falls back to a sparse ftruncate() where the file system or the
+// platform cannot reserve space.
+int reserve(int fd, std::size_t size) noexcept {
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__)
+  const auto error = ::posix_fallocate(fd, 0, off_t(size));
+  if (error != EINVAL && error != EOPNOTSUPP) return error;
+#endif
+  return (::ftruncate(fd, off_t(size)) == 0) ? 0 : errno;
+}
+
+}  // namespace
+
+mmap_sink::mmap_sink(const std::string& path, std::size_t max_size,
+                     unsigned max_files, bool strip)
+    : _path{path},
+      _max_size{std::max<std::size_t>(max_size, 4096)},
+      _max_files{max_files},
+      _strip{strip} {
+  for (unsigned i = 1; i <= max_files; ++i) {
+    _rotated.push_back(path + '.' + std::to_string(i));
+  }
+  open();
+}
+
+mmap_sink::~mmap_sink() {
+  if (color::get_sink() == this) color::set_sink();
+  sync();
+  close();
+}
+
+void mmap_sink::open() {
+  _fd = ::open(_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (_fd < 0) throw std::system_error(errno, std::generic_category(), _path);
+  struct stat info {};
+  if (::fstat(_fd, &info) != 0) {
+    const auto error = errno;
+    close();
+    throw std::system_error(error, std::generic_category(), _path);
+  }
+  const auto size = std::size_t(info.st_size);
+  if (size > _max_size) {
+    // Written with a larger limit: rotated away untouched.
+    close();
+    rotate_files();
+    open();
+    return;
+  }
+  // The blocks are reserved up front: a sparse file would turn a full disk
+  // into SIGBUS on a later store into the mapping.
+  const auto error = reserve(_fd, _max_size);
+  void* map{MAP_FAILED};
+  if (error == 0) {
+    map = ::mmap(nullptr, _max_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd,
+                 0);
+  }
+  if (map == MAP_FAILED) {
+    // The zero padding, if any, is recovered by the next open.
+    const auto map_error = (error != 0) ? error : errno;
+    close();
+    throw std::system_error(map_error, std::generic_category(), _path);
+  }
+  _map = static_cast<char*>(map);
+  _length = detail::recover_length(_map, size);
+  // A message cut by a crash still ends its line.
+  if (_length != 0 && _map[_length - 1] != '\n' && _length < _max_size) {
+    _map[_length++] = '\n';
+  }
+  _synced = _length;
+}
+
+void mmap_sink::close() noexcept {
+  if (_map != nullptr) {
+    ::munmap(_map, _max_size);
+    _map = nullptr;
+    if (::ftruncate(_fd, off_t(_length)) != 0) _error = errno;
+  }
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+  _length = 0;
+  _synced = 0;
+}
+
+void mmap_sink::rotate_files() noexcept {
+  if (_rotated.empty()) {
+    ::unlink(_path.c_str());
+    return;
+  }
+  for (auto i = _rotated.size() - 1; i != 0; --i) {
+    ::rename(_rotated[i - 1].c_str(), _rotated[i].c_str());
+  }
+  if (::rename(_path.c_str(), _rotated.front().c_str()) != 0) _error = errno;
+}
+
+bool mmap_sink::reopen() noexcept {
+  try {
+    open();
+    return true;
+  } catch (const std::system_error& error) {
+    _error = error.code().value();
+  } catch (...) {
+  }
+  return false;
+}
+
+void mmap_sink::write(const char* data, std::size_t size) noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  if (size > _max_size || (_map == nullptr && !reopen())) {
+    ++_dropped;
+    return;
+  }
+  if (_length + size > _max_size) {
+    close();
+    rotate_files();
+    if (!reopen()) {
+      ++_dropped;
+      return;
+    }
+  }
+  if (_strip) {
+    _length += _stripper.feed(data, size, _map + _length);
+  } else {
+    std::memcpy(_map + _length, data, size);
+    _length += size;
+  }
+  if (_length - _synced < _sync_interval) return;
+  static const auto page = std::size_t(::sysconf(_SC_PAGESIZE));
+  const auto start = _synced & ~(page - 1);
+  ::msync(_map + start, _length - start, MS_ASYNC);
+  _synced = _length;
+}
+
+void mmap_sink::sync() noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  if (_map == nullptr) return;
+  if (::msync(_map, _length, MS_SYNC) != 0) _error = errno;
+  _synced = _length;
+}
+
+void mmap_sink::rotate() noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  close();
+  rotate_files();
+  reopen();
+}
+
+#else
+
+mmap_sink::mmap_sink(const std::string&, std::size_t, unsigned, bool) {
+  throw std::system_error(
+      std::make_error_code(std::errc::function_not_supported), "mmap_sink");
+}
+
+mmap_sink::~mmap_sink() {}
+
+void mmap_sink::write(const char*, std::size_t) noexcept {}
+
+void mmap_sink::sync() noexcept {}
+
+void mmap_sink::rotate() noexcept {}
+
+#endif
+
+void mmap_sink::set_sync_interval(std::size_t bytes) noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _sync_interval = std::max<std::size_t>(bytes, 1);
+}
+
+std::size_t mmap_sink::size() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _length;
+}
+
+std::uint64_t mmap_sink::dropped() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _dropped;
+}
+
+int mmap_sink::error() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _error;
+}
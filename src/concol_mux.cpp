@@ -0,0 +1,194 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_mux.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <system_error>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+#include "concol_simd.h"
+
+using namespace concol;
+
+void output_mux::split(source& src, const char* data, std::size_t size) {
+  const char* pos{data};
+  const char* const end{data + size};
+  while (pos != end) {
+    const auto newline = detail::find_byte(pos, end, '\n');
+    if (newline == end) {
+      src.partial.append(pos, end);
+      if (src.partial.size() >= max_line) {
+        _out += src.prefix;
+        _out += src.partial;
+        _out += '\n';
+        src.partial.clear();
+      }
+      break;
+    }
+    _out += src.prefix;
+    if (!src.partial.empty()) {
+      _out += src.partial;
+      src.partial.clear();
+    }
+    _out.append(pos, newline + 1);
+    pos = newline + 1;
+  }
+}
+
+#ifdef __linux__
+
+output_mux::output_mux(std::size_t read_size)
+    : _buffer(std::max<std::size_t>(read_size, 4096)) {
+  _epoll = ::epoll_create1(EPOLL_CLOEXEC);
+  if (_epoll < 0) {
+    throw std::system_error(errno, std::generic_category(), "epoll_create1");
+  }
+}
+
+output_mux::~output_mux() {
+  for (auto& src : _sources) ::close(src->fd);
+  ::close(_epoll);
+}
+
+void output_mux::adopt(int fd, const std::string& name, color_type fg) {
+  auto src = std::make_unique<source>(source{fd, {}, {}});
+  if (color::is_enabled()) {
+    src->prefix = color::ansi_color_code(fg) + name + color::ansi_color_reset();
+  } else {
+    src->prefix = name;
+  }
+  src->prefix += " | ";
+  ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.ptr = src.get();
+  if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+    const auto error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "epoll_ctl");
+  }
+  _sources.push_back(std::move(src));
+}
+
+int output_mux::spawn(const std::string& command, const std::string& name,
+                      color_type fg) {
+  int fds[2];
+  if (::pipe2(fds, O_CLOEXEC) != 0) {
+    throw std::system_error(errno, std::generic_category(), "pipe2");
+  }
+  posix_spawn_file_actions_t actions;
+  ::posix_spawn_file_actions_init(&actions);
+  ::posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+  ::posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+  const char* argv[]{"sh", "-c", command.c_str(), nullptr};
+  pid_t pid{};
+  const auto error = ::posix_spawn(&pid, "/bin/sh", &actions, nullptr,
+                                   const_cast<char* const*>(argv), environ);
+  ::posix_spawn_file_actions_destroy(&actions);
+  ::close(fds[1]);
+  if (error != 0) {
+    ::close(fds[0]);
+    throw std::system_error(error, std::generic_category(), "posix_spawn");
+  }
+  adopt(fds[0], name, fg);
+  return int(pid);
+}
+
+void output_mux::close(source& src) {
+  if (!src.partial.empty()) {
+    _out += src.prefix;
+    _out += src.partial;
+    _out += '\n';
+  }
+  ::epoll_ctl(_epoll, EPOLL_CTL_DEL, src.fd, nullptr);
+  ::close(src.fd);
+  _sources.erase(std::find_if(_sources.begin(), _sources.end(),
+                              [&src](const std::unique_ptr<source>& val) {
+                                return val.get() == &src;
+                              }));
+}
+
+// Level triggered with one read per ready source and wakeup, so a chatty
+// child cannot starve the others.
+std::size_t output_mux::poll(int timeout_ms) {
+  if (_sources.empty()) return 0;
+  epoll_event events[64];
+  const auto count = ::epoll_wait(_epoll, events, 64, timeout_ms);
+  if (count < 0 && errno != EINTR) {
+    throw std::system_error(errno, std::generic_category(), "epoll_wait");
+  }
+  _out.clear();
+  for (int i = 0; i < count; ++i) {
+    auto& src = *static_cast<source*>(events[i].data.ptr);
+    const auto size = ::read(src.fd, _buffer.data(), _buffer.size());
+    if (size > 0) {
+      split(src, _buffer.data(), std::size_t(size));
+    } else if (size == 0 || (errno != EAGAIN && errno != EINTR)) {
+      close(src);
+    }
+  }
+  if (!_out.empty()) {
+    color::write(_out.data(), _out.size());
+    std::fflush(color::get_ostream());
+  }
+  return _sources.size();
+}
+
+#else
+
+output_mux::output_mux([[maybe_unused]] std::size_t read_size) {
+  throw std::system_error(
+      std::make_error_code(std::errc::function_not_supported), "output_mux");
+}
+
+output_mux::~output_mux() {}
+
+void output_mux::adopt(int, const std::string&, color_type) {}
+
+int output_mux::spawn(const std::string&, const std::string&, color_type) {
+  return -1;
+}
+
+void output_mux::close(source&) {}
+
+std::size_t output_mux::poll(int) { return 0; }
+
+#endif
+
+void output_mux::run() {
+  while (poll() != 0) {
+  }
+}
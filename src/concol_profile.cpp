@@ -0,0 +1,154 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_profile.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace concol;
+
+std::size_t latency_histogram::bucket_index(std::uint64_t ns) noexcept {
+  constexpr std::uint64_t sub_buckets{1u << sub_bucket_bits};
+  if (ns < sub_buckets) return std::size_t(ns);
+  int exponent{63};
+  while ((ns >> exponent) == 0) --exponent;
+  if (exponent > max_exponent) return bucket_count - 1;
+  const auto shift = exponent - sub_bucket_bits;
+  return (std::size_t(exponent - sub_bucket_bits + 1) << sub_bucket_bits) +
+         std::size_t((ns >> shift) & (sub_buckets - 1));
+}
+
+std::uint64_t latency_histogram::bucket_limit(std::size_t index) noexcept {
+  constexpr std::size_t sub_buckets{1u << sub_bucket_bits};
+  if (index < sub_buckets) return index;
+  const auto shift = int(index >> sub_bucket_bits) - 1;
+  const auto lower = std::uint64_t(sub_buckets + index % sub_buckets) << shift;
+  return lower + (std::uint64_t(1) << shift) - 1;
+}
+
+std::uint64_t latency_histogram::percentile(double quantile) const noexcept {
+  const auto count = this->count();
+  if (count == 0) return 0;
+  const auto rank = std::max<std::uint64_t>(
+      std::uint64_t(std::clamp(quantile, 0.0, 1.0) * double(count) + 0.5),
+      1);
+  std::uint64_t seen{};
+  for (std::size_t i = 0; i < bucket_count; ++i) {
+    seen += _buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank) return bucket_limit(i);
+  }
+  return bucket_limit(bucket_count - 1);
+}
+
+void latency_histogram::reset() noexcept {
+  for (auto& bucket : _buckets) bucket.store(0, std::memory_order_relaxed);
+  _count.store(0, std::memory_order_relaxed);
+  _total.store(0, std::memory_order_relaxed);
+}
+
+std::mutex callsite_profile::_mutex{};
+callsite_profile* callsite_profile::_head{};
+
+callsite_profile::callsite_profile(const char* file, int line)
+    : _file{file}, _line{line} {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _next = _head;
+  _head = this;
+}
+
+// Sites with automatic or member storage leave the list when they die.
+callsite_profile::~callsite_profile() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  for (auto link = &_head; *link != nullptr; link = &(*link)->_next) {
+    if (*link == this) {
+      *link = _next;
+      break;
+    }
+  }
+}
+
+void callsite_profile::record(std::uint64_t parse_ns, std::uint64_t format_ns,
+                              std::uint64_t write_ns,
+                              std::size_t bytes) noexcept {
+  _calls.fetch_add(1, std::memory_order_relaxed);
+  _bytes.fetch_add(bytes, std::memory_order_relaxed);
+  _phases[int(profile_phase::parse)].record(parse_ns);
+  _phases[int(profile_phase::format)].record(format_ns);
+  _phases[int(profile_phase::write)].record(write_ns);
+}
+
+std::uint64_t callsite_profile::total_ns() const noexcept {
+  std::uint64_t total{};
+  for (const auto& phase : _phases) total += phase.total();
+  return total;
+}
+
+void callsite_profile::report(std::FILE* stream, std::size_t top,
+                              profile_order order) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  std::vector<const callsite_profile*> sites{};
+  for (auto site = _head; site != nullptr; site = site->_next) {
+    if (site->calls() != 0) sites.push_back(site);
+  }
+  const auto key = [order](const callsite_profile* site) {
+    return (order == profile_order::time) ? site->total_ns() : site->bytes();
+  };
+  std::sort(sites.begin(), sites.end(),
+            [&](const callsite_profile* lhs, const callsite_profile* rhs) {
+              return key(lhs) > key(rhs);
+            });
+  if (sites.size() > top) sites.resize(top);
+  std::fprintf(stream, "%-28s %10s %12s %10s %15s %15s %15s\n", "call site",
+               "calls", "bytes", "total ms", "parse p50/p99",
+               "format p50/p99", "write p50/p99");
+  for (const auto site : sites) {
+    const char* name = std::strrchr(site->file(), '/');
+    name = (name == nullptr) ? site->file() : name + 1;
+    char where[64];
+    std::snprintf(where, sizeof(where), "%s:%d", name, site->line());
+    std::fprintf(stream, "%-28s %10llu %12llu %10.3f", where,
+                 static_cast<unsigned long long>(site->calls()),
+                 static_cast<unsigned long long>(site->bytes()),
+                 double(site->total_ns()) / 1e6);
+    for (const auto& phase : site->_phases) {
+      char latency[32];
+      std::snprintf(latency, sizeof(latency), "%llu/%llu",
+                    static_cast<unsigned long long>(phase.percentile(0.5)),
+                    static_cast<unsigned long long>(phase.percentile(0.99)));
+      std::fprintf(stream, " %15s", latency);
+    }
+    std::fputc('\n', stream);
+  }
+}
+
+void callsite_profile::reset_all() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  for (auto site = _head; site != nullptr; site = site->_next) {
+    site->_calls.store(0, std::memory_order_relaxed);
+    site->_bytes.store(0, std::memory_order_relaxed);
+    for (auto& phase : site->_phases) phase.reset();
+  }
+}
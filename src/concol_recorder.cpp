@@ -0,0 +1,138 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_recorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "concol_text.h"
+
+using namespace concol;
+
+flight_recorder::flight_recorder(std::size_t capacity, bool colored)
+    : _colored{colored} {
+  std::size_t size{64};
+  while (size < capacity) size <<= 1;
+  _buffer.reset(new char[size]);
+  _mask = size - 1;
+}
+
+flight_recorder::~flight_recorder() {
+  if (color::get_tee() == this) color::set_tee();
+}
+
+void flight_recorder::store(std::uint64_t pos, const char* data,
+                            std::size_t size) noexcept {
+  if (size > capacity()) {
+    pos += size - capacity();
+    data += size - capacity();
+    size = capacity();
+  }
+  const auto offset = std::size_t(pos & _mask);
+  const auto head = std::min(size, capacity() - offset);
+  std::memcpy(&_buffer[offset], data, head);
+  std::memcpy(&_buffer[0], data + head, size - head);
+}
+
+void flight_recorder::write(const char* data, std::size_t size) noexcept {
+  if (_colored) {
+    store(_head.fetch_add(size, std::memory_order_relaxed), data, size);
+    return;
+  }
+  const char* const end{data + size};
+  std::size_t plain{};
+  for (auto pos = data; pos != end;) {
+    const auto esc = static_cast<const char*>(
+        std::memchr(pos, '\x1b', std::size_t(end - pos)));
+    if (esc == nullptr) {
+      plain += std::size_t(end - pos);
+      break;
+    }
+    plain += std::size_t(esc - pos);
+    const auto sequence_size = detail::ansi_sequence_size(esc, end);
+    pos = (sequence_size == 0) ? end : esc + sequence_size;
+  }
+  auto head = _head.fetch_add(plain, std::memory_order_relaxed);
+  for (auto pos = data; pos != end;) {
+    auto esc = static_cast<const char*>(
+        std::memchr(pos, '\x1b', std::size_t(end - pos)));
+    if (esc == nullptr) esc = end;
+    store(head, pos, std::size_t(esc - pos));
+    head += std::uint64_t(esc - pos);
+    if (esc == end) break;
+    const auto sequence_size = detail::ansi_sequence_size(esc, end);
+    pos = (sequence_size == 0) ? end : esc + sequence_size;
+  }
+}
+
+std::size_t flight_recorder::size() const noexcept {
+  const auto head = _head.load(std::memory_order_relaxed);
+  return std::size_t(head - first(head));
+}
+
+std::uint64_t flight_recorder::first(std::uint64_t head) const noexcept {
+  if (head <= capacity()) return 0;
+  for (auto pos = head - capacity(); pos != head; ++pos) {
+    if (_buffer[std::size_t(pos & _mask)] == '\n') return pos + 1;
+  }
+  return head - capacity();
+}
+
+std::string flight_recorder::snapshot() const {
+  const auto head = _head.load(std::memory_order_acquire);
+  std::string str{};
+  str.reserve(capacity());
+  for (auto pos = first(head); pos != head;) {
+    const auto offset = std::size_t(pos & _mask);
+    const auto size = std::min(std::size_t(head - pos), capacity() - offset);
+    str.append(&_buffer[offset], size);
+    pos += size;
+  }
+  return str;
+}
+
+void flight_recorder::dump(int fd) const noexcept {
+  const auto head = _head.load(std::memory_order_acquire);
+  for (auto pos = first(head); pos != head;) {
+    const auto offset = std::size_t(pos & _mask);
+    const auto size = std::min(std::size_t(head - pos), capacity() - offset);
+#ifdef _WIN32
+    const auto written = ::_write(fd, &_buffer[offset], unsigned(size));
+#else
+    const auto written = ::write(fd, &_buffer[offset], size);
+#endif
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return;
+    pos += std::uint64_t(written);
+  }
+}
@@ -0,0 +1,255 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_screen.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "concol_text.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr char32_t invalid_cell{0xFFFFFFFF};
+
+void append_utf8(std::string& out, char32_t cp) {
+  if (cp < 0x80) {
+    out += char(cp);
+  } else if (cp < 0x800) {
+    out += char(0xC0 | (cp >> 6));
+    out += char(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += char(0xE0 | (cp >> 12));
+    out += char(0x80 | ((cp >> 6) & 0x3F));
+    out += char(0x80 | (cp & 0x3F));
+  } else {
+    out += char(0xF0 | (cp >> 18));
+    out += char(0x80 | ((cp >> 12) & 0x3F));
+    out += char(0x80 | ((cp >> 6) & 0x3F));
+    out += char(0x80 | (cp & 0x3F));
+  }
+}
+
+void append_number(std::string& out, std::size_t value) {
+  char digits[24];
+  auto size = std::snprintf(digits, sizeof(digits), "%zu", value);
+  out.append(digits, std::size_t(size));
+}
+
+}  // namespace
+
+screen::screen(std::size_t width, std::size_t height) {
+  resize(width, height);
+}
+
+void screen::resize(std::size_t width, std::size_t height) {
+  _width = width;
+  _height = height;
+  _back.assign(width * height, screen_cell{});
+  invalidate();
+}
+
+void screen::clear(const screen_cell& fill) {
+  _back.assign(_width * _height, fill);
+}
+
+void screen::put(std::size_t x, std::size_t y, char32_t ch, color_type fg,
+                 color_type bg) {
+  if (x >= _width || y >= _height) return;
+  auto cells = &_back[y * _width];
+  // Overwriting either half of a wide character blanks the other half.
+  if (cells[x].ch == 0 && x != 0) {
+    cells[x - 1].ch = U' ';
+  }
+  if (x + 1 < _width && cells[x + 1].ch == 0) {
+    cells[x + 1].ch = U' ';
+  }
+  cells[x] = screen_cell{ch, fg, bg};
+  if (detail::codepoint_width(ch) == 2) {
+    if (x + 1 < _width) {
+      if (x + 2 < _width && cells[x + 2].ch == 0) {
+        cells[x + 2].ch = U' ';
+      }
+      cells[x + 1] = screen_cell{0, fg, bg};
+    } else {
+      cells[x].ch = U' ';
+    }
+  }
+}
+
+std::size_t screen::print(std::size_t x, std::size_t y,
+                          std::string_view markup, color_type fg,
+                          color_type bg) {
+  const auto start = x;
+  auto current = fg;
+  auto current_bg = bg;
+  const char* pos{markup.data()};
+  const char* const end{pos + markup.size()};
+  while (pos != end && x < _width) {
+    if (*pos == '{') {
+      auto close = static_cast<const char*>(
+          std::memchr(pos + 1, '}', std::size_t(end - pos - 1)));
+      if (close != nullptr) {
+        const auto tag = pos + 1;
+        const auto tag_size = std::size_t(close - tag);
+        color_type tag_fg{};
+        if (detail::find_color_tag(tag, tag_size, tag_fg)) {
+          current = (tag_fg == color_type::none) ? fg : tag_fg;
+          current_bg = bg;
+          pos = close + 1;
+          continue;
+        }
+        if (const auto style = detail::find_theme_tag(tag, tag_size)) {
+          current = style->fg;
+          current_bg = style->bg;
+          pos = close + 1;
+          continue;
+        }
+      }
+    }
+    const auto byte = static_cast<unsigned char>(*pos);
+    std::size_t length{1};
+    char32_t cp{byte};
+    if ((byte & 0xE0) == 0xC0) {
+      length = 2;
+      cp = byte & 0x1F;
+    } else if ((byte & 0xF0) == 0xE0) {
+      length = 3;
+      cp = byte & 0x0F;
+    } else if ((byte & 0xF8) == 0xF0) {
+      length = 4;
+      cp = byte & 0x07;
+    }
+    if (length > std::size_t(end - pos)) {
+      length = 1;
+      cp = U'?';
+    }
+    for (std::size_t i{1}; i < length; ++i) {
+      cp = (cp << 6) | (static_cast<unsigned char>(pos[i]) & 0x3F);
+    }
+    pos += length;
+    const auto cp_width = detail::codepoint_width(cp);
+    if (cp_width == 0) continue;
+    if (x + cp_width > _width) break;
+    put(x, y, cp, current, current_bg);
+    x += cp_width;
+  }
+  return x - start;
+}
+
+void screen::invalidate() {
+  _front.assign(_width * _height, screen_cell{invalid_cell});
+}
+
+void screen::render(std::string& out) {
+  CONCOL_AUDIT_SCOPE("screen::render");
+  const bool enabled{color::is_enabled()};
+  // The style in effect on the terminal is unknown until the first write.
+  bool style_known{};
+  color_type style_fg{};
+  color_type style_bg{};
+  std::size_t cursor_x{_width};
+  std::size_t cursor_y{_height};
+  auto set_style = [&](const screen_cell& cell) {
+    if (!enabled) return;
+    if (style_known && cell.fg == style_fg && cell.bg == style_bg) return;
+    if (cell.fg == color_type::none && cell.bg == color_type::none) {
+      out += color::ansi_color_reset();
+    } else {
+      out += color::ansi_color_code(cell.fg, cell.bg);
+    }
+    style_known = true;
+    style_fg = cell.fg;
+    style_bg = cell.bg;
+  };
+  auto same_style = [&](const screen_cell& cell) {
+    return !enabled ||
+           (style_known && cell.fg == style_fg && cell.bg == style_bg);
+  };
+  for (std::size_t y{}; y < _height; ++y) {
+    const auto row = y * _width;
+    for (std::size_t x{}; x < _width; ++x) {
+      const auto& cell = _back[row + x];
+      if (cell.ch == 0) continue;
+      const bool wide{x + 1 < _width && _back[row + x + 1].ch == 0};
+      if (cell == _front[row + x] &&
+          (!wide || _back[row + x + 1] == _front[row + x + 1])) {
+        continue;
+      }
+      if (cursor_y != y || cursor_x != x) {
+        // Reprinting a short run of unchanged ASCII cells in the current
+        // style is cheaper than the shortest cursor move.
+        bool reprint{cursor_y == y && cursor_x < x && x - cursor_x <= 3};
+        for (auto gap = cursor_x; reprint && gap < x; ++gap) {
+          const auto& skipped = _back[row + gap];
+          reprint = skipped.ch >= 0x20 && skipped.ch < 0x7F &&
+                    same_style(skipped);
+        }
+        if (reprint) {
+          for (auto gap = cursor_x; gap < x; ++gap) {
+            out += char(_back[row + gap].ch);
+          }
+        } else if (cursor_y == y && cursor_x < x) {
+          out += "\x1b[";
+          append_number(out, x - cursor_x);
+          out += 'C';
+        } else {
+          out += "\x1b[";
+          append_number(out, y + 1);
+          out += ';';
+          append_number(out, x + 1);
+          out += 'H';
+        }
+      }
+      set_style(cell);
+      append_utf8(out, cell.ch);
+      _front[row + x] = cell;
+      cursor_y = y;
+      cursor_x = x + 1;
+      if (wide) {
+        _front[row + x + 1] = _back[row + x + 1];
+        cursor_x += 1;
+      }
+      if (cursor_x >= _width) {
+        // Pending wrap: the real cursor position is terminal specific.
+        cursor_y = _height;
+      }
+    }
+  }
+  if (style_known &&
+      (style_fg != color_type::none || style_bg != color_type::none)) {
+    out += color::ansi_color_reset();
+  }
+}
+
+void screen::present() {
+  _out.clear();
+  render(_out);
+  if (_out.empty()) return;
+  color::write(_out.data(), _out.size());
+  std::fflush(color::get_ostream());
+}
@@ -0,0 +1,297 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define CONCOL_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+// vmaxvq_u8 and vqtbl1q_u8 are AArch64 only: 32-bit ARM takes the scalar
+// path.
+#include <arm_neon.h>
+#define CONCOL_SIMD_NEON
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Byte scanning kernels shared by the text utilities. Not part of the
+// installed interface.
+
+namespace concol {
+namespace detail {
+
+inline unsigned count_trailing_zeros(unsigned mask) noexcept {
+#ifdef _MSC_VER
+  unsigned long index{};
+  _BitScanForward(&index, mask);
+  return unsigned(index);
+#else
+  return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+inline bool plain_ascii(unsigned char byte, char stop) noexcept {
+  return byte >= 0x20 && byte < 0x7F &&
+         byte != static_cast<unsigned char>(stop);
+}
+
+// Number of leading bytes of [pos, end) that are printable ASCII
+// (0x20..0x7E) and differ from `stop`; each of them is one column wide.
+inline std::size_t plain_ascii_prefix(const char* pos, const char* end,
+                                      char stop) noexcept {
+  const char* const begin{pos};
+#if defined(__AVX2__)
+  const auto low32 = _mm256_set1_epi8(0x20);
+  const auto del32 = _mm256_set1_epi8(0x7F);
+  const auto stop32 = _mm256_set1_epi8(stop);
+  for (; end - pos >= 32; pos += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+    const auto special = _mm256_or_si256(
+        _mm256_cmpgt_epi8(low32, v),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, del32),
+                        _mm256_cmpeq_epi8(v, stop32)));
+    const auto mask = unsigned(_mm256_movemask_epi8(special));
+    if (mask != 0) {
+      return std::size_t(pos - begin) + count_trailing_zeros(mask);
+    }
+  }
+#endif
+#if defined(CONCOL_SIMD_SSE2)
+  const auto low = _mm_set1_epi8(0x20);
+  const auto del = _mm_set1_epi8(0x7F);
+  const auto stop16 = _mm_set1_epi8(stop);
+  for (; end - pos >= 16; pos += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    // Signed compare: bytes >= 0x80 are negative and count as special too.
+    const auto special =
+        _mm_or_si128(_mm_cmplt_epi8(v, low),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, del),
+                                  _mm_cmpeq_epi8(v, stop16)));
+    const auto mask = unsigned(_mm_movemask_epi8(special));
+    if (mask != 0) {
+      return std::size_t(pos - begin) + count_trailing_zeros(mask);
+    }
+  }
+#elif defined(CONCOL_SIMD_NEON)
+  const auto low = vdupq_n_u8(0x20);
+  const auto del = vdupq_n_u8(0x7F);
+  const auto stop16 = vdupq_n_u8(static_cast<unsigned char>(stop));
+  for (; end - pos >= 16; pos += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const unsigned char*>(pos));
+    const auto special = vorrq_u8(vcltq_u8(v, low),
+                                  vorrq_u8(vcgeq_u8(v, del),
+                                           vceqq_u8(v, stop16)));
+    if (vmaxvq_u8(special) != 0) break;
+  }
+#endif
+  while (pos != end && plain_ascii(static_cast<unsigned char>(*pos), stop)) {
+    ++pos;
+  }
+  return std::size_t(pos - begin);
+}
+
+// First occurrence of `byte` in [pos, end), or `end`.
+inline const char* find_byte(const char* pos, const char* end,
+                             char byte) noexcept {
+#if defined(__AVX2__)
+  const auto byte32 = _mm256_set1_epi8(byte);
+  for (; end - pos >= 32; pos += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+    const auto mask =
+        unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, byte32)));
+    if (mask != 0) return pos + count_trailing_zeros(mask);
+  }
+#endif
+#if defined(CONCOL_SIMD_SSE2)
+  const auto byte16 = _mm_set1_epi8(byte);
+  for (; end - pos >= 16; pos += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    const auto mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, byte16)));
+    if (mask != 0) return pos + count_trailing_zeros(mask);
+  }
+#elif defined(CONCOL_SIMD_NEON)
+  const auto byte16 = vdupq_n_u8(static_cast<unsigned char>(byte));
+  for (; end - pos >= 16; pos += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const unsigned char*>(pos));
+    if (vmaxvq_u8(vceqq_u8(v, byte16)) != 0) break;
+  }
+#endif
+  while (pos != end && *pos != byte) ++pos;
+  return pos;
+}
+
+// First byte of [pos, end) equal to one of `a`, `b`, `c` or `d` (repeat a
+// byte to look for fewer), or `end`. This is the structural scan of the
+// highlighter: string bodies and bare words are skipped a block at a time.
+inline const char* find_any_of(const char* pos, const char* end, char a,
+                               char b, char c, char d) noexcept {
+#if defined(__AVX2__)
+  const auto a32 = _mm256_set1_epi8(a);
+  const auto b32 = _mm256_set1_epi8(b);
+  const auto c32 = _mm256_set1_epi8(c);
+  const auto d32 = _mm256_set1_epi8(d);
+  for (; end - pos >= 32; pos += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+    const auto hits = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, a32), _mm256_cmpeq_epi8(v, b32)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, c32), _mm256_cmpeq_epi8(v, d32)));
+    const auto mask = unsigned(_mm256_movemask_epi8(hits));
+    if (mask != 0) return pos + count_trailing_zeros(mask);
+  }
+#endif
+#if defined(CONCOL_SIMD_SSE2)
+  const auto a16 = _mm_set1_epi8(a);
+  const auto b16 = _mm_set1_epi8(b);
+  const auto c16 = _mm_set1_epi8(c);
+  const auto d16 = _mm_set1_epi8(d);
+  for (; end - pos >= 16; pos += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    const auto hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, a16), _mm_cmpeq_epi8(v, b16)),
+        _mm_or_si128(_mm_cmpeq_epi8(v, c16), _mm_cmpeq_epi8(v, d16)));
+    const auto mask = unsigned(_mm_movemask_epi8(hits));
+    if (mask != 0) return pos + count_trailing_zeros(mask);
+  }
+#elif defined(CONCOL_SIMD_NEON)
+  const auto a16 = vdupq_n_u8(static_cast<unsigned char>(a));
+  const auto b16 = vdupq_n_u8(static_cast<unsigned char>(b));
+  const auto c16 = vdupq_n_u8(static_cast<unsigned char>(c));
+  const auto d16 = vdupq_n_u8(static_cast<unsigned char>(d));
+  for (; end - pos >= 16; pos += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const unsigned char*>(pos));
+    const auto hits = vorrq_u8(vorrq_u8(vceqq_u8(v, a16), vceqq_u8(v, b16)),
+                               vorrq_u8(vceqq_u8(v, c16), vceqq_u8(v, d16)));
+    if (vmaxvq_u8(hits) != 0) break;
+  }
+#endif
+  while (pos != end && *pos != a && *pos != b && *pos != c && *pos != d) {
+    ++pos;
+  }
+  return pos;
+}
+
+// Writes the two lowercase hex digits of each of the 16 bytes at `in` to
+// `out`, high nibble first (32 chars). The nibbles index a 16-byte digit
+// table with one shuffle (SSSE3, NEON); plain SSE2 adds 'a' - '0' - 10 to
+// the nibbles above 9 instead.
+inline void hex_digits16(const unsigned char* in, char* out) noexcept {
+#if defined(__SSSE3__) || defined(__AVX2__)
+  const auto digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                    '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const auto nibble = _mm_set1_epi8(0x0F);
+  const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  const auto high = _mm_shuffle_epi8(
+      digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+  const auto low = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                   _mm_unpacklo_epi8(high, low));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16),
+                   _mm_unpackhi_epi8(high, low));
+#elif defined(CONCOL_SIMD_SSE2)
+  const auto nibble = _mm_set1_epi8(0x0F);
+  const auto nine = _mm_set1_epi8(9);
+  const auto zero = _mm_set1_epi8('0');
+  const auto letter = _mm_set1_epi8('a' - '0' - 10);
+  const auto to_hex = [&](__m128i n) {
+    return _mm_add_epi8(_mm_add_epi8(n, zero),
+                        _mm_and_si128(_mm_cmpgt_epi8(n, nine), letter));
+  };
+  const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  const auto high = to_hex(_mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+  const auto low = to_hex(_mm_and_si128(v, nibble));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                   _mm_unpacklo_epi8(high, low));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16),
+                   _mm_unpackhi_epi8(high, low));
+#elif defined(CONCOL_SIMD_NEON)
+  const auto digits =
+      vld1q_u8(reinterpret_cast<const unsigned char*>("0123456789abcdef"));
+  const auto v = vld1q_u8(in);
+  uint8x16x2_t pairs{};
+  pairs.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(v, 4));
+  pairs.val[1] = vqtbl1q_u8(digits, vandq_u8(v, vdupq_n_u8(0x0F)));
+  vst2q_u8(reinterpret_cast<unsigned char*>(out), pairs);
+#else
+  constexpr char digits[]{"0123456789abcdef"};
+  for (std::size_t i{}; i < 16; ++i) {
+    out[2 * i] = digits[in[i] >> 4];
+    out[2 * i + 1] = digits[in[i] & 0x0F];
+  }
+#endif
+}
+
+// Copies [pos, end) to `out` up to the first `byte` and returns the number
+// of bytes copied. `out` may overlap the input as long as out <= pos: a
+// block is stored only once it has been loaded and found clean, so no
+// unread input is overwritten.
+inline std::size_t copy_until_byte(const char* pos, const char* end, char* out,
+                                   char byte) noexcept {
+  const char* const begin{pos};
+#if defined(__AVX2__)
+  const auto byte32 = _mm256_set1_epi8(byte);
+  for (; end - pos >= 32; pos += 32, out += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+    const auto mask =
+        unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, byte32)));
+    if (mask != 0) {
+      const auto size = count_trailing_zeros(mask);
+      std::memmove(out, pos, size);
+      return std::size_t(pos - begin) + size;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+  }
+#endif
+#if defined(CONCOL_SIMD_SSE2)
+  const auto byte16 = _mm_set1_epi8(byte);
+  for (; end - pos >= 16; pos += 16, out += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    const auto mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, byte16)));
+    if (mask != 0) {
+      const auto size = count_trailing_zeros(mask);
+      std::memmove(out, pos, size);
+      return std::size_t(pos - begin) + size;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+  }
+#elif defined(CONCOL_SIMD_NEON)
+  const auto byte16 = vdupq_n_u8(static_cast<unsigned char>(byte));
+  for (; end - pos >= 16; pos += 16, out += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const unsigned char*>(pos));
+    if (vmaxvq_u8(vceqq_u8(v, byte16)) != 0) break;
+    vst1q_u8(reinterpret_cast<unsigned char*>(out), v);
+  }
+#endif
+  for (; pos != end && *pos != byte; ++pos, ++out) *out = *pos;
+  return std::size_t(pos - begin);
+}
+
+}  // namespace detail
+}  // namespace concol
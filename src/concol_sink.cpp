@@ -0,0 +1,228 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+#ifndef _WIN32
+
+fd_sink::fd_sink(int fd, std::size_t capacity)
+    : _fd{fd},
+      _buffer{new char[std::max<std::size_t>(capacity, 64)]},
+      _capacity{std::max<std::size_t>(capacity, 64)} {
+  if (fd < 0) {
+    throw std::system_error(
+        std::make_error_code(std::errc::bad_file_descriptor), "fd_sink");
+  }
+}
+
+fd_sink::~fd_sink() {
+  if (color::get_sink() == this) color::set_sink();
+  flush();
+}
+
+std::size_t fd_sink::send(const char* data, std::size_t size,
+                          bool& failed) noexcept {
+  std::size_t sent{};
+  while (sent != size) {
+    const auto result = ::write(_fd, data + sent, size - sent);
+    if (result >= 0) {
+      sent += std::size_t(result);
+      continue;
+    }
+    if (errno == EINTR) continue;
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      fail(errno);
+      failed = true;
+    }
+    break;
+  }
+  return sent;
+}
+
+bool fd_sink::send_pending() noexcept {
+  while (_size != 0) {
+    const auto first = std::min(_size, _capacity - _head);
+    iovec parts[2]{{&_buffer[_head], first}, {&_buffer[0], _size - first}};
+    const auto result = ::writev(_fd, parts, (first == _size) ? 1 : 2);
+    if (result >= 0) {
+      _head = (_head + std::size_t(result)) % _capacity;
+      _size -= std::size_t(result);
+      continue;
+    }
+    if (errno == EINTR) continue;
+    if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+    fail(errno);
+    return false;
+  }
+  if (_size == 0) _head = 0;
+  if (_size <= _high_watermark) _above_watermark = false;
+  return true;
+}
+
+void fd_sink::push(const char* data, std::size_t size) noexcept {
+  const auto tail = (_head + _size) % _capacity;
+  const auto first = std::min(size, _capacity - tail);
+  std::memcpy(&_buffer[tail], data, first);
+  std::memcpy(&_buffer[0], data + first, size - first);
+  _size += size;
+}
+
+// The tail of a message cannot be resent after an error, so the buffer is
+// given up as a whole and the next message starts from a reset.
+void fd_sink::fail(int error) noexcept {
+  _error = error;
+  if (_size != 0) ++_dropped;
+  _head = 0;
+  _size = 0;
+  _reset_pending = true;
+}
+
+bool fd_sink::check_watermark() noexcept {
+  if (_high_watermark == 0 || _above_watermark || _size <= _high_watermark) {
+    return false;
+  }
+  _above_watermark = true;
+  return true;
+}
+
+void fd_sink::write(const char* data, std::size_t size) noexcept {
+  std::size_t pending{};
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    send_pending();
+    const auto reset = color::ansi_color_reset();
+    const std::size_t reset_size{
+        (_reset_pending && color::is_enabled()) ? std::strlen(reset) : 0};
+    if (reset_size + size > _capacity - _size) {
+      ++_dropped;
+      _reset_pending = true;
+      return;
+    }
+    _reset_pending = false;
+    bool failed{};
+    std::pair<const char*, std::size_t> parts[2]{{reset, reset_size},
+                                                 {data, size}};
+    for (auto& part : parts) {
+      if (_size == 0) {
+        const auto sent = send(part.first, part.second, failed);
+        if (failed) {
+          ++_dropped;
+          return;
+        }
+        part.first += sent;
+        part.second -= sent;
+      }
+      push(part.first, part.second);
+    }
+    if (!check_watermark()) return;
+    pending = _size;
+  }
+  if (_on_high_watermark) {
+    try {
+      _on_high_watermark(pending);
+    } catch (...) {
+    }
+  }
+}
+
+std::size_t fd_sink::flush() noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  send_pending();
+  return _size;
+}
+
+std::size_t fd_sink::flush(int timeout_ms) noexcept {
+  using clock = std::chrono::steady_clock;
+  const auto deadline = clock::now() + std::chrono::milliseconds{timeout_ms};
+  for (;;) {
+    const auto pending = flush();
+    if (pending == 0) return 0;
+    int wait{-1};
+    if (timeout_ms >= 0) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - clock::now());
+      if (left.count() <= 0) return pending;
+      wait = int(left.count());
+    }
+    pollfd entry{_fd, POLLOUT, 0};
+    const auto result = ::poll(&entry, 1, wait);
+    if (result < 0 && errno != EINTR) return pending;
+  }
+}
+
+#else
+
+fd_sink::fd_sink(int, std::size_t) {
+  throw std::system_error(
+      std::make_error_code(std::errc::function_not_supported), "fd_sink");
+}
+
+fd_sink::~fd_sink() {}
+
+void fd_sink::write(const char*, std::size_t) noexcept {}
+
+std::size_t fd_sink::flush() noexcept { return 0; }
+
+std::size_t fd_sink::flush(int) noexcept { return 0; }
+
+#endif
+
+void fd_sink::set_high_watermark(std::size_t bytes,
+                                 watermark_callback callback) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _high_watermark = bytes;
+  _on_high_watermark = std::move(callback);
+  _above_watermark = false;
+}
+
+std::size_t fd_sink::pending() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _size;
+}
+
+std::uint64_t fd_sink::dropped() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _dropped;
+}
+
+int fd_sink::error() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _error;
+}
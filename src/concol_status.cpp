@@ -0,0 +1,232 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_status.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "concol_text.h"
+
+using namespace concol;
+
+progress_bar::progress_bar(std::string label, std::uint64_t total,
+                           color_type fg)
+    : _total{total}, _label{std::move(label)}, _fg{fg} {}
+
+status_line::status_line(unsigned max_fps, std::size_t width)
+    : _width{width} {
+  set_max_fps(max_fps);
+}
+
+status_line::~status_line() { stop(); }
+
+progress_bar& status_line::add_bar(std::string label, std::uint64_t total,
+                                   color_type fg) {
+  _bars.emplace_back(std::move(label), total, fg);
+  return _bars.back();
+}
+
+void status_line::set_max_fps(unsigned max_fps) noexcept {
+  using clock = std::chrono::steady_clock;
+  clock::duration interval{};
+  if (max_fps != 0) {
+    interval = std::chrono::duration_cast<clock::duration>(
+                   std::chrono::seconds{1}) /
+               max_fps;
+  }
+  _interval.store(interval.count(), std::memory_order_relaxed);
+}
+
+void status_line::layout(const progress_bar& bar, std::size_t label_width) {
+  const auto current = bar.current();
+  const auto total = bar.total();
+  const auto done = (total == 0) ? 1.0 : std::min(1.0, double(current) / total);
+  char suffix[64];
+  auto suffix_size = std::snprintf(suffix, sizeof(suffix), "] %3u%% %llu/%llu",
+                                   unsigned(done * 100),
+                                   static_cast<unsigned long long>(current),
+                                   static_cast<unsigned long long>(total));
+  const std::size_t fixed{label_width + 2 + std::size_t(suffix_size)};
+  const std::size_t bar_width{(_width > fixed + 10) ? _width - fixed : 10};
+  const auto filled = std::size_t(done * bar_width);
+
+  _line.clear();
+  std::size_t column{};
+  auto put = [&](char ch, color_type fg) {
+    if (column < _width) {
+      _line.push_back(cell{ch, fg, column++});
+    }
+  };
+  // The label goes in one UTF-8 character at a time: its bytes take the
+  // column where it starts, and zero-width marks the one before.
+  const auto label =
+      truncate_to_width(bar._label, std::min(label_width, _width));
+  std::size_t previous{};
+  for (std::size_t i{}; i < label.size();) {
+    auto end = i + 1;
+    while (end < label.size() && (label[end] & 0xC0) == 0x80) ++end;
+    const auto width = visible_width(label.substr(i, end - i));
+    const auto start = (width == 0 && i != 0) ? previous : column;
+    for (; i < end; ++i) {
+      _line.push_back(cell{label[i], color_type::none, start});
+    }
+    previous = start;
+    column += width;
+  }
+  while (column < std::min(label_width, _width)) put(' ', color_type::none);
+  put(' ', color_type::none);
+  put('[', color_type::none);
+  for (std::size_t i{}; i < bar_width; ++i) {
+    if (i < filled) {
+      put('#', bar._fg);
+    } else {
+      put('-', color_type::black_bright);
+    }
+  }
+  for (int i{}; i < suffix_size; ++i) put(suffix[i], color_type::none);
+  while (column < _width) put(' ', color_type::none);
+}
+
+void status_line::append_cells(std::string& out, const cell* first,
+                               const cell* last, color_type& current) const {
+  for (; first != last; ++first) {
+    if (first->fg != current) {
+      if (color::is_enabled()) {
+        if (first->fg == color_type::none) {
+          out += color::ansi_color_reset();
+        } else {
+          out += color::ansi_color_code(first->fg);
+        }
+      }
+      current = first->fg;
+    }
+    out += first->ch;
+  }
+}
+
+void status_line::render(std::string& out) {
+  std::size_t label_width{};
+  for (const auto& bar : _bars) {
+    label_width = std::max(label_width, visible_width(bar._label));
+  }
+  const auto out_size = out.size();
+  auto current = color_type::none;
+  auto row = _frame.size();
+  auto move_to = [&](std::size_t target) {
+    if (row > target) {
+      out += "\x1b[" + std::to_string(row - target) + 'A';
+    } else if (row < target) {
+      out += "\x1b[" + std::to_string(target - row) + 'B';
+    }
+    row = target;
+  };
+  for (std::size_t i{}; i < _bars.size(); ++i) {
+    layout(_bars[i], label_width);
+    if (i < _frame.size()) {
+      auto& last_line = _frame[i];
+      auto first_diff = _line.begin();
+      auto last_diff = _line.end();
+      if (last_line.size() == _line.size()) {
+        first_diff = std::mismatch(_line.begin(), _line.end(),
+                                   last_line.begin())
+                         .first;
+        if (first_diff == _line.end()) continue;
+        while (*(last_diff - 1) ==
+               last_line[std::size_t((last_diff - 1) - _line.begin())]) {
+          --last_diff;
+        }
+        // Whole characters only: the diff may start or end inside one.
+        while (first_diff != _line.begin() &&
+               (first_diff - 1)->column == first_diff->column) {
+          --first_diff;
+        }
+        while (last_diff != _line.end() &&
+               last_diff->column == (last_diff - 1)->column) {
+          ++last_diff;
+        }
+      }
+      move_to(i);
+      out += "\x1b[" + std::to_string(first_diff->column + 1) + 'G';
+      append_cells(out, &*first_diff, &*first_diff + (last_diff - first_diff),
+                   current);
+      last_line = _line;
+    } else {
+      move_to(_frame.size());
+      out += '\r';
+      append_cells(out, _line.data(), _line.data() + _line.size(), current);
+      if (current != color_type::none && color::is_enabled()) {
+        out += color::ansi_color_reset();
+      }
+      current = color_type::none;
+      out += '\n';
+      row += 1;
+      _frame.push_back(_line);
+    }
+  }
+  if (out.size() == out_size) return;
+  if (current != color_type::none && color::is_enabled()) {
+    out += color::ansi_color_reset();
+  }
+  move_to(_frame.size());
+  out += '\r';
+}
+
+bool status_line::refresh(bool force) {
+  const auto now = std::chrono::steady_clock::now();
+  const std::chrono::steady_clock::duration interval{
+      _interval.load(std::memory_order_relaxed)};
+  if (!force && _last.time_since_epoch().count() != 0 &&
+      now - _last < interval) {
+    return false;
+  }
+  _last = now;
+  _out.clear();
+  render(_out);
+  if (_out.empty()) return false;
+  color::write(_out.data(), _out.size());
+  std::fflush(color::get_ostream());
+  return true;
+}
+
+void status_line::start() {
+  if (_running.exchange(true)) return;
+  _thread = std::thread([this] {
+    while (_running.load(std::memory_order_acquire)) {
+      refresh();
+      const std::chrono::steady_clock::duration interval{
+          _interval.load(std::memory_order_relaxed)};
+      std::this_thread::sleep_for(
+          std::max<std::chrono::steady_clock::duration>(
+              interval, std::chrono::milliseconds{1}));
+    }
+  });
+}
+
+void status_line::stop() {
+  if (!_running.exchange(false)) return;
+  _thread.join();
+  refresh(true);
+}
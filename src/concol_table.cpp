@@ -0,0 +1,195 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_table.h"
+
+#include <algorithm>
+
+#include "concol_text.h"
+
+using namespace concol;
+using namespace detail;
+
+std::size_t table_layout::append_cell(std::string& out,
+                                      const table_cell& cell) {
+  const auto offset = out.size();
+  const bool wrap{cell.fg != color_type::none && color::is_enabled()};
+  if (wrap) {
+    out += color::ansi_color_code(cell.fg);
+  }
+  color::append_parsed(out, cell.text.data(), cell.text.size());
+  if (wrap) {
+    out += color::ansi_color_reset();
+  }
+  return visible_width({out.data() + offset, out.size() - offset});
+}
+
+void table_layout::append_padded(std::string& out, const char* text,
+                                 std::size_t size, std::size_t width,
+                                 std::size_t column) const {
+  const auto pad = (width < _widths[column]) ? _widths[column] - width : 0;
+  const bool last{column + 1 == _widths.size()};
+  if (column != 0) {
+    out += _separator;
+  }
+  if (_aligns[column] == table_align::right) {
+    out.append(pad, ' ');
+    out.append(text, size);
+  } else {
+    out.append(text, size);
+    if (!last) {
+      out.append(pad, ' ');
+    }
+  }
+}
+
+table& table::set_align(std::size_t column, table_align align) {
+  _aligns[column] = align;
+  return *this;
+}
+
+table& table::set_separator(std::string separator) {
+  _separator = std::move(separator);
+  return *this;
+}
+
+void table::reserve(std::size_t rows, std::size_t text_bytes) {
+  _cells.reserve(rows * columns());
+  _text.reserve(text_bytes);
+}
+
+table& table::add_row(std::initializer_list<table_cell> cells) {
+  return add_row(cells.begin(), cells.size());
+}
+
+table& table::add_row(const table_cell* cells, std::size_t count) {
+  for (std::size_t column{}; column < columns(); ++column) {
+    const auto offset = _text.size();
+    std::size_t width{};
+    if (column < count) {
+      width = append_cell(_text, cells[column]);
+    }
+    _cells.push_back(cell_ref{offset, _text.size() - offset, width});
+    _widths[column] = std::max(_widths[column], width);
+  }
+  return *this;
+}
+
+void table::clear() noexcept {
+  _text.clear();
+  _cells.clear();
+  std::fill(_widths.begin(), _widths.end(), 0);
+}
+
+void table::render(std::string& out) const {
+  CONCOL_AUDIT_SCOPE("table::render");
+  if (columns() == 0) return;
+  std::size_t size{_text.size() +
+                   rows() * (_separator.size() * (columns() - 1) + 1)};
+  for (std::size_t i{}; i < _cells.size(); ++i) {
+    const auto column = i % columns();
+    if (column + 1 != columns() || _aligns[column] == table_align::right) {
+      size += _widths[column] - _cells[i].width;
+    }
+  }
+  out.reserve(out.size() + size);
+  for (std::size_t i{}; i < _cells.size(); ++i) {
+    const auto& cell = _cells[i];
+    const auto column = i % columns();
+    append_padded(out, _text.data() + cell.offset, cell.size, cell.width,
+                  column);
+    if (column + 1 == columns()) {
+      out += '\n';
+    }
+  }
+}
+
+std::string table::to_string() const {
+  std::string str{};
+  render(str);
+  return str;
+}
+
+void table::print() const {
+  auto str = to_string();
+  color::write(str.data(), str.size());
+}
+
+table_writer::table_writer(std::vector<std::size_t> widths,
+                           std::FILE* stream, std::size_t chunk_size)
+    : table_layout{widths.size()}, _stream{stream}, _chunk_size{chunk_size} {
+  _widths = std::move(widths);
+  _buffer.reserve(_chunk_size + _chunk_size / 2);
+}
+
+table_writer::~table_writer() { flush(); }
+
+table_writer& table_writer::set_align(std::size_t column, table_align align) {
+  _aligns[column] = align;
+  return *this;
+}
+
+table_writer& table_writer::set_separator(std::string separator) {
+  _separator = std::move(separator);
+  return *this;
+}
+
+table_writer& table_writer::add_row(std::initializer_list<table_cell> cells) {
+  return add_row(cells.begin(), cells.size());
+}
+
+table_writer& table_writer::add_row(const table_cell* cells,
+                                    std::size_t count) {
+  for (std::size_t column{}; column < columns(); ++column) {
+    _cell.clear();
+    std::size_t width{};
+    if (column < count) {
+      width = append_cell(_cell, cells[column]);
+    }
+    if (width > _widths[column]) {
+      _cell.resize(truncate_to_width(_cell, _widths[column]).size());
+      width = visible_width(_cell);
+      if (color::is_enabled()) {
+        _cell += color::ansi_color_reset();
+      }
+    }
+    append_padded(_buffer, _cell.data(), _cell.size(), width, column);
+  }
+  _buffer += '\n';
+  if (_buffer.size() >= _chunk_size) {
+    flush();
+  }
+  return *this;
+}
+
+void table_writer::flush() {
+  if (_buffer.empty()) return;
+  if (_stream == nullptr) {
+    color::write(_buffer.data(), _buffer.size());
+  } else {
+    std::fwrite(_buffer.data(), 1, _buffer.size(), _stream);
+  }
+  _buffer.clear();
+}
@@ -0,0 +1,287 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_text.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "concol.h"
+#include "concol_simd.h"
+
+namespace concol {
+namespace detail {
+
+namespace {
+
+struct codepoint_range {
+  char32_t first;
+  char32_t last;
+};
+
+constexpr codepoint_range zero_width[]{
+    {0x0300, 0x036F},   {0x0483, 0x0489},   {0x0591, 0x05BD},
+    {0x0610, 0x061A},   {0x064B, 0x065F},   {0x0E31, 0x0E31},
+    {0x0E34, 0x0E3A},   {0x1AB0, 0x1AFF},   {0x1DC0, 0x1DFF},
+    {0x200B, 0x200F},   {0x20D0, 0x20FF},   {0xFE00, 0xFE0F},
+    {0xFE20, 0xFE2F},   {0xE0100, 0xE01EF}};
+
+constexpr codepoint_range double_width[]{
+    {0x1100, 0x115F},   {0x2E80, 0x303E},   {0x3041, 0x33FF},
+    {0x3400, 0x4DBF},   {0x4E00, 0x9FFF},   {0xA000, 0xA4CF},
+    {0xAC00, 0xD7A3},   {0xF900, 0xFAFF},   {0xFE30, 0xFE4F},
+    {0xFF00, 0xFF60},   {0xFFE0, 0xFFE6},   {0x1F300, 0x1F64F},
+    {0x1F900, 0x1F9FF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}};
+
+template <std::size_t Size>
+bool in_ranges(const codepoint_range (&ranges)[Size], char32_t cp) noexcept {
+  auto it = std::upper_bound(
+      std::begin(ranges), std::end(ranges), cp,
+      [](char32_t value, const codepoint_range& range) {
+        return value < range.first;
+      });
+  return it != std::begin(ranges) && cp <= std::prev(it)->last;
+}
+
+}  // namespace
+
+std::size_t codepoint_width(char32_t cp) noexcept {
+  if (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) return 0;
+  if (cp < 0x300) return 1;
+  if (in_ranges(zero_width, cp)) return 0;
+  if (in_ranges(double_width, cp)) return 2;
+  return 1;
+}
+
+std::size_t ansi_sequence_size(const char* str, const char* end) noexcept {
+  if (end - str < 2) return 0;
+  const char* pos{str + 2};
+  switch (str[1]) {
+    case '[':
+      for (; pos != end; ++pos) {
+        if (*pos >= 0x40 && *pos <= 0x7E) return std::size_t(pos - str + 1);
+      }
+      return 0;
+    case ']':
+      for (; pos != end; ++pos) {
+        if (*pos == '\a') return std::size_t(pos - str + 1);
+        if (*pos == '\x1b') {
+          if (pos + 1 == end) return 0;
+          if (pos[1] == '\\') return std::size_t(pos - str + 2);
+        }
+      }
+      return 0;
+    default:
+      // nF escapes such as "\x1b(B" carry intermediate bytes first.
+      for (pos = str + 1; pos != end; ++pos) {
+        if (*pos < 0x20 || *pos > 0x2F) return std::size_t(pos - str + 1);
+      }
+      return 0;
+  }
+}
+
+}  // namespace detail
+}  // namespace concol
+
+namespace {
+
+using namespace concol;
+using namespace detail;
+
+struct scan_result {
+  std::size_t size;
+  std::size_t width;
+};
+
+// Walks the text until `limit` columns are used up. Plain ASCII runs are
+// consumed by the SIMD kernel; everything else goes through the escape, tag
+// and UTF-8 decoder one element at a time.
+scan_result scan(const char* str, std::size_t size, text_format format,
+                 std::size_t limit) noexcept {
+  const char* pos{str};
+  const char* const end{str + size};
+  const char stop{(format == text_format::markup) ? '{' : '\x1b'};
+  std::size_t width{};
+  while (pos != end) {
+    const auto plain = plain_ascii_prefix(pos, end, stop);
+    if (plain != 0) {
+      const auto room = limit - width;
+      if (plain > room) {
+        pos += room;
+        width += room;
+        break;
+      }
+      pos += plain;
+      width += plain;
+      continue;
+    }
+    const auto byte = static_cast<unsigned char>(*pos);
+    if (byte == 0x1b) {
+      const auto sequence_size = ansi_sequence_size(pos, end);
+      pos = (sequence_size == 0) ? end : pos + sequence_size;
+      continue;
+    }
+    if (byte == '{') {
+      auto close = static_cast<const char*>(
+          std::memchr(pos + 1, '}', std::size_t(end - pos - 1)));
+      const char* escape{};
+      std::size_t escape_size{};
+      if (close != nullptr &&
+          find_tag_escape(pos + 1, std::size_t(close - pos - 1), escape,
+                          escape_size)) {
+        pos = close + 1;
+        continue;
+      }
+      // Unknown tags are printed verbatim, up to and including the brace.
+      const char* literal_end{(close == nullptr) ? end : close + 1};
+      auto literal = scan(pos, std::size_t(literal_end - pos),
+                          text_format::ansi, limit - width);
+      pos += literal.size;
+      width += literal.width;
+      if (pos != literal_end) break;
+      continue;
+    }
+    std::size_t length{1};
+    char32_t cp{byte};
+    if ((byte & 0xE0) == 0xC0) {
+      length = 2;
+      cp = byte & 0x1F;
+    } else if ((byte & 0xF0) == 0xE0) {
+      length = 3;
+      cp = byte & 0x0F;
+    } else if ((byte & 0xF8) == 0xF0) {
+      length = 4;
+      cp = byte & 0x07;
+    }
+    std::size_t cp_width{1};
+    if (byte < 0x80) {
+      cp_width = 0;
+    } else if (length != 1 && std::size_t(end - pos) >= length) {
+      for (std::size_t i{1}; i < length; ++i) {
+        cp = (cp << 6) | (static_cast<unsigned char>(pos[i]) & 0x3F);
+      }
+      cp_width = codepoint_width(cp);
+    } else {
+      length = 1;
+    }
+    if (width + cp_width > limit) break;
+    width += cp_width;
+    pos += length;
+  }
+  return {std::size_t(pos - str), width};
+}
+
+}  // namespace
+
+std::size_t concol::visible_width(std::string_view str,
+                                  text_format format) noexcept {
+  CONCOL_AUDIT_SCOPE("visible_width");
+  return scan(str.data(), str.size(), format,
+              std::numeric_limits<std::size_t>::max())
+      .width;
+}
+
+std::string_view concol::truncate_to_width(std::string_view str,
+                                           std::size_t width,
+                                           text_format format) noexcept {
+  return str.substr(0, scan(str.data(), str.size(), format, width).size);
+}
+
+// Clean runs are scanned and copied 16 or 32 bytes at a time; complete
+// sequences are skipped with ansi_sequence_size(), and only a sequence cut
+// by the end of a chunk goes through the byte-wise state machine.
+char* ansi_stripper::strip(const char* pos, const char* end,
+                           char* out) noexcept {
+  while (pos != end) {
+    if (_state == state::plain) {
+      const auto size = copy_until_byte(pos, end, out, '\x1b');
+      out += size;
+      pos += size;
+      if (pos == end) break;
+      const auto sequence_size = ansi_sequence_size(pos, end);
+      if (sequence_size != 0) {
+        pos += sequence_size;
+        continue;
+      }
+      _state = state::escape;
+      ++pos;
+      continue;
+    }
+    const auto ch = *pos++;
+    switch (_state) {
+      case state::escape:
+        if (ch >= 0x20 && ch <= 0x2F) break;
+        _state = state::plain;
+        if (ch == '[') _state = state::csi;
+        if (ch == ']') _state = state::osc;
+        break;
+      case state::csi:
+        if (ch >= 0x40 && ch <= 0x7E) _state = state::plain;
+        break;
+      case state::osc:
+        if (ch == '\a') _state = state::plain;
+        if (ch == '\x1b') _state = state::osc_escape;
+        break;
+      default:
+        _state = state::osc;
+        if (ch == '\\' || ch == '\a') _state = state::plain;
+        if (ch == '\x1b') _state = state::osc_escape;
+        break;
+    }
+  }
+  return out;
+}
+
+void ansi_stripper::feed(std::string_view chunk, std::string& out) {
+  CONCOL_AUDIT_SCOPE("ansi_stripper::feed");
+  const auto offset = out.size();
+  out.resize(offset + chunk.size());
+  const auto stop = strip(chunk.data(), chunk.data() + chunk.size(),
+                          &out[offset]);
+  out.resize(std::size_t(stop - out.data()));
+}
+
+std::size_t ansi_stripper::feed(char* str, std::size_t size) noexcept {
+  CONCOL_AUDIT_SCOPE("ansi_stripper::feed");
+  return std::size_t(strip(str, str + size, str) - str);
+}
+
+std::size_t ansi_stripper::feed(const char* data, std::size_t size,
+                                char* out) noexcept {
+  CONCOL_AUDIT_SCOPE("ansi_stripper::feed");
+  return std::size_t(strip(data, data + size, out) - out);
+}
+
+std::string concol::strip_ansi(std::string_view str) {
+  std::string out{};
+  ansi_stripper{}.feed(str, out);
+  return out;
+}
+
+std::size_t concol::strip_ansi(char* str, std::size_t size) noexcept {
+  return ansi_stripper{}.feed(str, size);
+}
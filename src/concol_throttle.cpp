@@ -0,0 +1,125 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_throttle.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace concol;
+
+namespace {
+
+// Longest interval and burst tolerance in nanoseconds (about 36 years), so
+// that arrival times stay far from overflowing.
+constexpr std::int64_t max_interval{std::int64_t(1) << 60};
+
+}  // namespace
+
+std::mutex callsite_throttle::_mutex{};
+callsite_throttle* callsite_throttle::_head{};
+
+callsite_throttle::callsite_throttle(const char* file, int line)
+    : _file{file}, _line{line}, _last_report{now()} {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _next = _head;
+  _head = this;
+}
+
+// Throttles with automatic or member storage leave the list when they die.
+callsite_throttle::~callsite_throttle() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  for (auto link = &_head; *link != nullptr; link = &(*link)->_next) {
+    if (*link == this) {
+      *link = _next;
+      break;
+    }
+  }
+}
+
+std::int64_t callsite_throttle::now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void callsite_throttle::report(std::int64_t now_ns, bool force) {
+  auto last = _last_report.load(std::memory_order_relaxed);
+  if (!force && now_ns - last < report_interval) return;
+  if (!_last_report.compare_exchange_strong(last, now_ns,
+                                            std::memory_order_relaxed)) {
+    return;
+  }
+  const auto count = _suppressed.exchange(0, std::memory_order_relaxed);
+  if (count == 0) return;
+  color::printf("{+yellow}suppressed %llu messages from %s:%d{}\n",
+                static_cast<unsigned long long>(count), _file, _line);
+}
+
+void callsite_throttle::report_all() {
+  const auto now_ns = now();
+  std::lock_guard<std::mutex> lock{_mutex};
+  for (auto site = _head; site != nullptr; site = site->_next) {
+    site->report(now_ns, true);
+  }
+}
+
+rate_limiter::rate_limiter(double per_second, unsigned burst,
+                           const char* file, int line)
+    : callsite_throttle{file, line} {
+  if (!(per_second > 0)) {
+    // A negative tolerance rejects every message.
+    _interval = 0;
+    _tolerance = -1;
+    return;
+  }
+  const double interval{1e9 / per_second};
+  _interval = (interval < double(max_interval)) ? std::int64_t(interval)
+                                                : max_interval;
+  const std::int64_t extra{std::int64_t(std::max(burst, 1u) - 1)};
+  _tolerance = (_interval == 0 || extra <= max_interval / _interval)
+                   ? _interval * extra
+                   : max_interval;
+}
+
+bool rate_limiter::allow() {
+  const auto now_ns = now();
+  auto arrival = _arrival.load(std::memory_order_relaxed);
+  for (;;) {
+    const auto base = std::max(arrival, now_ns);
+    if (base - now_ns > _tolerance) {
+      drop();
+      // A site that drops everything still prints its periodic summary.
+      maybe_report(now_ns);
+      return false;
+    }
+    if (_arrival.compare_exchange_weak(arrival, base + _interval,
+                                       std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  maybe_report(now_ns);
+  return true;
+}
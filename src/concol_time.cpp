@@ -0,0 +1,142 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_time.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+using namespace concol;
+
+std::atomic<unsigned> timestamp::_generation{};
+std::mutex timestamp::_mutex{};
+std::string timestamp::_style{};
+unsigned timestamp::_precision{3};
+bool timestamp::_utc{};
+
+void timestamp::set_style(const std::string& tag) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _style = tag;
+  _generation.fetch_add(1, std::memory_order_release);
+}
+
+void timestamp::set_precision(unsigned digits) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _precision = (digits > 9) ? 9 : digits;
+  _generation.fetch_add(1, std::memory_order_release);
+}
+
+void timestamp::set_utc(bool utc) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _utc = utc;
+  _generation.fetch_add(1, std::memory_order_release);
+}
+
+void timestamp::append(std::string& out, bool markup) {
+  CONCOL_AUDIT_SCOPE("timestamp::append");
+  struct cache {
+    std::time_t second{-1};
+    unsigned generation{};
+    int mode{-1};
+    unsigned precision{};
+    std::string text{};
+    std::size_t fraction{};
+  };
+  thread_local cache cached{};
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now);
+  const auto second = std::time_t(seconds.count());
+  const auto generation = _generation.load(std::memory_order_acquire);
+  const int mode{markup ? 2 : (color::is_enabled() ? 1 : 0)};
+
+  if (cached.second != second || cached.generation != generation ||
+      cached.mode != mode) {
+    std::string style{};
+    bool utc{};
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+      style = _style;
+      utc = _utc;
+      cached.precision = _precision;
+    }
+    std::tm tm{};
+#ifdef _WIN32
+    if (utc) {
+      gmtime_s(&tm, &second);
+    } else {
+      localtime_s(&tm, &second);
+    }
+#else
+    if (utc) {
+      gmtime_r(&second, &tm);
+    } else {
+      localtime_r(&second, &tm);
+    }
+#endif
+    char text[32];
+    auto size = std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &tm);
+    cached.text.clear();
+    if (!style.empty()) {
+      if (markup) {
+        cached.text += style;
+      } else {
+        color::append_parsed(cached.text, style.data(), style.size());
+      }
+    }
+    cached.text.append(text, size);
+    if (cached.precision != 0) {
+      cached.text += '.';
+    }
+    cached.fraction = cached.text.size();
+    cached.text.append(cached.precision, '0');
+    if (!style.empty()) {
+      if (markup) {
+        cached.text += detail::color_tags::reset;
+      } else if (mode == 1) {
+        cached.text += color::ansi_color_reset();
+      }
+    }
+    cached.text += ' ';
+    cached.second = second;
+    cached.generation = generation;
+    cached.mode = mode;
+  }
+
+  const auto offset = out.size();
+  out += cached.text;
+  auto fraction = std::uint64_t(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - seconds)
+          .count());
+  for (auto i = cached.precision; i < 9; ++i) {
+    fraction /= 10;
+  }
+  for (auto i = cached.precision; i != 0; --i) {
+    out[offset + cached.fraction + i - 1] = char('0' + fraction % 10);
+    fraction /= 10;
+  }
+}
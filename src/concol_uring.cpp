@@ -0,0 +1,399 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "concol_uring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+#ifdef __linux__
+
+struct uring_sink::ring {
+  int fd{-1};
+  bool fixed{};
+  void* sq_ptr{MAP_FAILED};
+  std::size_t sq_size{};
+  void* cq_ptr{MAP_FAILED};
+  std::size_t cq_size{};
+  io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+  std::size_t sqes_size{};
+  unsigned* sq_tail{};
+  unsigned* sq_mask{};
+  unsigned* sq_array{};
+  unsigned* cq_head{};
+  unsigned* cq_tail{};
+  unsigned* cq_mask{};
+  io_uring_cqe* cqes{};
+  std::unique_ptr<iovec[]> iovecs{};
+
+  ~ring() { close(); }
+
+  void close() noexcept {
+    if (sqes != MAP_FAILED) ::munmap(sqes, sqes_size);
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) ::munmap(cq_ptr, cq_size);
+    if (sq_ptr != MAP_FAILED) ::munmap(sq_ptr, sq_size);
+    if (fd >= 0) ::close(fd);
+    sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    cq_ptr = sq_ptr = MAP_FAILED;
+    fd = -1;
+  }
+};
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params* params) noexcept {
+  return int(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                   unsigned flags) noexcept {
+  return int(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                       flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, const void* arg,
+                      unsigned count) noexcept {
+  return int(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+template <typename T>
+T* at(void* base, std::uint32_t offset) noexcept {
+  return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+}  // namespace
+
+uring_sink::uring_sink(int fd, std::size_t buffer_size, unsigned buffers,
+                       bool use_io_uring)
+    : _fd{fd},
+      _buffer_size{std::max<std::size_t>(buffer_size, 4096)},
+      _count{std::max(buffers, 2u)},
+      _ring{new ring{}} {
+  if (fd < 0) {
+    throw std::system_error(
+        std::make_error_code(std::errc::bad_file_descriptor), "uring_sink");
+  }
+  _storage.reset(new char[_buffer_size * _count]);
+  _buffers.reset(new buffer[_count]);
+  _ring->iovecs.reset(new iovec[_count]);
+  for (unsigned i = 0; i < _count; ++i) {
+    _buffers[i] = buffer{&_storage[i * _buffer_size], 0, 0, false};
+    _ring->iovecs[i] = iovec{_buffers[i].data, _buffer_size};
+  }
+  const auto position = ::lseek(fd, 0, SEEK_CUR);
+  const auto flags = ::fcntl(fd, F_GETFL);
+  _positional = position >= 0 && flags >= 0 && (flags & O_APPEND) == 0;
+  _offset = _positional ? std::uint64_t(position) : 0;
+  setup_ring(use_io_uring && _positional);
+}
+
+void uring_sink::setup_ring(bool use_io_uring) noexcept {
+  if (!use_io_uring) return;
+  auto& r = *_ring;
+  io_uring_params params{};
+  r.fd = io_uring_setup(_count, &params);
+  if (r.fd < 0) return;
+  r.sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  r.cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single{(params.features & IORING_FEAT_SINGLE_MMAP) != 0};
+  if (single) r.sq_size = r.cq_size = std::max(r.sq_size, r.cq_size);
+  r.sq_ptr = ::mmap(nullptr, r.sq_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQ_RING);
+  if (r.sq_ptr != MAP_FAILED) {
+    r.cq_ptr = single ? r.sq_ptr
+                      : ::mmap(nullptr, r.cq_size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, r.fd,
+                               IORING_OFF_CQ_RING);
+  }
+  if (r.cq_ptr != MAP_FAILED) {
+    r.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    r.sqes = static_cast<io_uring_sqe*>(
+        ::mmap(nullptr, r.sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQES));
+  }
+  if (r.sqes == MAP_FAILED) {
+    r.close();
+    return;
+  }
+  r.sq_tail = at<unsigned>(r.sq_ptr, params.sq_off.tail);
+  r.sq_mask = at<unsigned>(r.sq_ptr, params.sq_off.ring_mask);
+  r.sq_array = at<unsigned>(r.sq_ptr, params.sq_off.array);
+  r.cq_head = at<unsigned>(r.cq_ptr, params.cq_off.head);
+  r.cq_tail = at<unsigned>(r.cq_ptr, params.cq_off.tail);
+  r.cq_mask = at<unsigned>(r.cq_ptr, params.cq_off.ring_mask);
+  r.cqes = at<io_uring_cqe>(r.cq_ptr, params.cq_off.cqes);
+  // Registration pins the buffers; it fails under a low RLIMIT_MEMLOCK,
+  // and plain vectored writes are used then.
+  r.fixed = io_uring_register(r.fd, IORING_REGISTER_BUFFERS, r.iovecs.get(),
+                              _count) == 0;
+}
+
+uring_sink::~uring_sink() {
+  if (color::get_sink() == this) color::set_sink();
+  flush();
+}
+
+void uring_sink::write(const char* data, std::size_t size) noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  while (size != 0) {
+    auto& buf = _buffers[_current];
+    const auto part = std::min(size, _buffer_size - buf.size);
+    std::memcpy(buf.data + buf.size, data, part);
+    buf.size += part;
+    data += part;
+    size -= part;
+    if (buf.size == _buffer_size) queue_current();
+  }
+}
+
+// Hands the current buffer over and makes sure the next one is free.
+void uring_sink::queue_current() noexcept {
+  auto& buf = _buffers[_current];
+  buf.offset = _offset;
+  buf.busy = true;
+  _offset += buf.size;
+  if (_ring->fd >= 0) {
+    auto& r = *_ring;
+    const auto tail = *r.sq_tail;
+    const auto index = tail & *r.sq_mask;
+    auto& sqe = r.sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.fd = _fd;
+    sqe.off = buf.offset;
+    sqe.user_data = _current;
+    if (r.fixed) {
+      sqe.opcode = IORING_OP_WRITE_FIXED;
+      sqe.addr = reinterpret_cast<std::uint64_t>(buf.data);
+      sqe.len = std::uint32_t(buf.size);
+      sqe.buf_index = std::uint16_t(_current);
+    } else {
+      r.iovecs[_current].iov_len = buf.size;
+      sqe.opcode = IORING_OP_WRITEV;
+      sqe.addr = reinterpret_cast<std::uint64_t>(&r.iovecs[_current]);
+      sqe.len = 1;
+    }
+    r.sq_array[index] = index;
+    __atomic_store_n(r.sq_tail, tail + 1, __ATOMIC_RELEASE);
+  }
+  ++_queued;
+  _current = (_current + 1) % _count;
+  const bool next_busy{_buffers[_current].busy};
+  if (!next_busy && _queued < std::max(_count / 2, 1u)) return;
+  if (_ring->fd < 0) {
+    write_queued();
+    return;
+  }
+  submit(false);
+  while (_buffers[_current].busy) submit(true);
+}
+
+void uring_sink::submit(bool wait_one) noexcept {
+  for (;;) {
+    const auto result =
+        io_uring_enter(_ring->fd, _queued, wait_one ? 1 : 0,
+                       wait_one ? IORING_ENTER_GETEVENTS : 0);
+    ++_syscalls;
+    if (result >= 0) {
+      _queued -= unsigned(result);
+      _in_flight += unsigned(result);
+      break;
+    }
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      abandon_ring(errno);
+      return;
+    }
+  }
+  reap();
+}
+
+// A ring that no longer accepts submissions cannot be waited on either:
+// the buffers in flight are counted as failed, and the ones that were
+// never submitted go out through the writev path, which takes over.
+void uring_sink::abandon_ring(int error) noexcept {
+  _ring->close();
+  const auto first_queued = (_current + _count - _queued) % _count;
+  for (unsigned i = 0; i < _count; ++i) {
+    auto& buf = _buffers[i];
+    if (!buf.busy || (i + _count - first_queued) % _count < _queued) {
+      continue;
+    }
+    ++_failed;
+    buf.size = 0;
+    buf.busy = false;
+  }
+  _error = error;
+  _in_flight = 0;
+  write_queued();
+}
+
+void uring_sink::reap() noexcept {
+  auto& r = *_ring;
+  auto head = *r.cq_head;
+  const auto tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const auto& cqe = r.cqes[head & *r.cq_mask];
+    finish(_buffers[cqe.user_data], cqe.res);
+    --_in_flight;
+  }
+  __atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Completes a write; the rare short write is finished with pwrite.
+void uring_sink::finish(buffer& buf, long result) noexcept {
+  std::size_t done{result > 0 ? std::size_t(result) : 0};
+  if (result < 0) {
+    ++_failed;
+    _error = int(-result);
+    done = buf.size;
+  }
+  while (done < buf.size) {
+    const auto size = ::pwrite(_fd, buf.data + done, buf.size - done,
+                               off_t(buf.offset + done));
+    ++_syscalls;
+    if (size > 0) {
+      done += std::size_t(size);
+      continue;
+    }
+    if (size < 0 && errno == EINTR) continue;
+    // A write that takes nothing would never finish.
+    ++_failed;
+    _error = (size < 0) ? errno : EIO;
+    break;
+  }
+  buf.size = 0;
+  buf.busy = false;
+}
+
+// The writev path: every queued buffer, oldest first, in one call.
+void uring_sink::write_queued() noexcept {
+  if (_queued == 0) return;
+  auto iovecs = _ring->iovecs.get();
+  const auto first = (_current + _count - _queued) % _count;
+  const auto offset = _buffers[first].offset;
+  std::size_t total{};
+  for (unsigned i = 0; i < _queued; ++i) {
+    const auto& buf = _buffers[(first + i) % _count];
+    iovecs[i] = iovec{buf.data, buf.size};
+    total += buf.size;
+  }
+  int count = int(_queued);
+  std::size_t done{};
+  while (done < total) {
+    const auto size =
+        _positional ? ::pwritev(_fd, iovecs, count, off_t(offset + done))
+                    : ::writev(_fd, iovecs, count);
+    ++_syscalls;
+    if (size <= 0) {
+      if (size < 0 && errno == EINTR) continue;
+      ++_failed;
+      _error = (size < 0) ? errno : EIO;
+      break;
+    }
+    done += std::size_t(size);
+    for (auto left = std::size_t(size); left != 0;) {
+      const auto part = std::min(left, iovecs->iov_len);
+      iovecs->iov_base = static_cast<char*>(iovecs->iov_base) + part;
+      iovecs->iov_len -= part;
+      left -= part;
+      if (iovecs->iov_len == 0 && count > 1) {
+        ++iovecs;
+        --count;
+      }
+    }
+  }
+  for (unsigned i = 0; i < _queued; ++i) {
+    auto& buf = _buffers[(first + i) % _count];
+    buf.size = 0;
+    buf.busy = false;
+  }
+  _queued = 0;
+}
+
+void uring_sink::flush_locked() noexcept {
+  if (_buffers[_current].size != 0) queue_current();
+  if (_ring->fd >= 0) {
+    while (_queued != 0 || _in_flight != 0) submit(true);
+  } else {
+    write_queued();
+  }
+  if (_positional) ::lseek(_fd, off_t(_offset), SEEK_SET);
+}
+
+#else
+
+struct uring_sink::ring {
+  int fd{-1};
+};
+
+uring_sink::uring_sink(int, std::size_t, unsigned, bool) {
+  throw std::system_error(
+      std::make_error_code(std::errc::function_not_supported), "uring_sink");
+}
+
+uring_sink::~uring_sink() {}
+
+void uring_sink::write(const char*, std::size_t) noexcept {}
+
+void uring_sink::flush_locked() noexcept {}
+
+#endif
+
+void uring_sink::flush() noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  flush_locked();
+}
+
+bool uring_sink::uses_io_uring() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _ring->fd >= 0;
+}
+
+std::uint64_t uring_sink::syscalls() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _syscalls;
+}
+
+std::uint64_t uring_sink::failed() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _failed;
+}
+
+int uring_sink::error() const noexcept {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _error;
+}
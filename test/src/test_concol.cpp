@@ -358,6 +358,15 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
       .add('\n');
   color::printf(color1.c_str() + color2.to_string());
 
+#ifndef CONCOL_NO_STRING_VIEW
+  const char view_buffer[]{"{+green}view{}{+red} tail is not printed"};
+  const std::string_view view{view_buffer, 14};
+  color::printf(view);
+  color::printf("\n"sv);
+  std::cout << color::to_string("%s {+cyan}%d{}"sv, "to_string", 42) << '\n';
+  color(view).add(", "sv).add_blue_bright(view.substr(8, 4)).add('\n').print();
+#endif
+
   return 0;
 } catch (...) {
   std::cerr << "\nunexpected exception\n";
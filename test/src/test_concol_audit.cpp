@@ -0,0 +1,115 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_audit.h"
+#include "concol_deferred.h"
+#include "concol_html.h"
+#include "concol_log.h"
+#include "concol_text.h"
+#include "concol_time.h"
+
+using namespace concol;
+
+namespace {
+
+void check_no_allocations(const char* name) {
+  const auto entry = alloc_audit::find(name);
+  if (entry.calls == 0 || entry.allocations != 0) {
+    std::cerr << "FAILED: " << name << " made " << entry.allocations
+              << " allocations in " << entry.calls << " calls\n";
+    ++failures;
+  }
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+  color::set_enabled(true);
+  logger::set_timestamp(true);
+
+  std::string out{};
+  out.reserve(4096);
+  std::string html{};
+  html.reserve(4096);
+  char buffer[]{"\x1b[31mred\x1b[0m plain"};
+  html_converter converter{text_format::markup};
+  deferred_printer deferred{256};
+  deferred.start();
+
+  // The first round warms up the thread-local buffers and caches.
+  for (int round = 0; round < 2; ++round) {
+    if (round == 1) alloc_audit::reset();
+    for (int i = 0; i < 100; ++i) {
+      color::printf("{+red}value{} %d {green}%s{}\n", i, "text");
+      out.clear();
+      color::append_parsed(out, "{+red}value{} {blue}more{}", 26);
+      check(visible_width("{+red}value{}", text_format::markup) == 5,
+            "visible width");
+      CONCOL_LOG_INFO("message %d", i);
+      timestamp::append(out);
+      std::size_t size = sizeof(buffer) - 1;
+      size = ansi_stripper{}.feed(buffer, size);
+      check(size <= sizeof(buffer) - 1, "stripped size");
+      html.clear();
+      converter.feed("{red}html{} text", html);
+      check(deferred.printf("deferred %d\n", i), "deferred queued");
+    }
+  }
+  deferred.stop();
+  check(deferred.dropped() == 0, "deferred records written");
+
+  check_no_allocations("color::printf");
+  check_no_allocations("color::append_parsed");
+  check_no_allocations("visible_width");
+  check_no_allocations("logger::log");
+  check_no_allocations("timestamp::append");
+  check_no_allocations("ansi_stripper::feed");
+  check_no_allocations("html_converter::feed");
+  check_no_allocations("deferred_printer::printf");
+
+  // Paths that return a new string must show up in the audit.
+  const auto text = color::to_string(
+      "{+red}a string that is too long for the small buffer{}");
+  check(!text.empty(), "to_string result");
+  check(alloc_audit::find("color::to_string").allocations != 0,
+        "to_string allocations are counted");
+  check(alloc_audit::find("not an entry point").calls == 0,
+        "unknown entry point");
+
+  color::set_ostream(stdout);
+  std::fclose(stream);
+  if (failures != 0) alloc_audit::report(stderr);
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,111 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "concol_batch.h"
+
+using namespace concol;
+
+namespace {
+
+std::string read_all(std::FILE* stream) {
+  std::string str(std::size_t(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  auto size = std::fread(&str[0], 1, str.size(), stream);
+  str.resize(size);
+  return str;
+}
+
+struct string_tee final : detail::output_tee {
+  std::string data{};
+  void write(const char* str, std::size_t size) noexcept override {
+    data.append(str, size);
+  }
+};
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  color::set_enabled(true);
+  batch_pool pool{4};
+
+  std::vector<std::string> records{};
+  std::string expected{};
+  for (int i{}; i < 20000; ++i) {
+    records.push_back("{+green}record{} {cyan}" + std::to_string(i) + "{}\n");
+    expected += color::to_string(records.back());
+  }
+
+  std::FILE* stream = std::tmpfile();
+  render_batch(records, pool, stream);
+  check(read_all(stream) == expected, "markup records keep their order");
+  std::fclose(stream);
+
+  std::vector<int> values(20000);
+  for (std::size_t i{}; i < values.size(); ++i) values[i] = int(i);
+  stream = std::tmpfile();
+  render_batch(
+      values,
+      [](int value, std::string& markup) {
+        markup += "{+green}record{} {cyan}" + std::to_string(value) + "{}\n";
+      },
+      pool, stream);
+  check(read_all(stream) == expected, "formatted records keep their order");
+  std::fclose(stream);
+
+  // Without a stream the output goes through color::write() and the tee.
+  stream = std::tmpfile();
+  color::set_ostream(stream);
+  string_tee tee{};
+  color::set_tee(&tee);
+  render_batch(records, pool);
+  color::set_tee();
+  std::fflush(stream);
+  check(read_all(stream) == expected && tee.data == expected,
+        "default output reaches the tee");
+  color::set_ostream(stdout);
+  std::fclose(stream);
+
+  bool thrown{};
+  try {
+    pool.run(100, [](std::size_t task, std::size_t) {
+      if (task == 42) throw std::runtime_error{"task"};
+    });
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  check(thrown, "exceptions reach the caller");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,145 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "concol_binlog.h"
+
+using namespace concol;
+
+namespace {
+
+std::vector<unsigned char> read_file(const char* path) {
+  std::ifstream file{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file},
+          std::istreambuf_iterator<char>{}};
+}
+
+std::string decode(const std::vector<unsigned char>& data) {
+  std::string out{};
+  decode_binary_log(data.data(), data.size(), out);
+  return out;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+#ifndef _WIN32
+  const char* path{"test_concol_binlog.bin"};
+  {
+    binary_log log{path, 1 << 16};
+    for (int i = 0; i < 2; ++i) {
+      CONCOL_BINLOG(log, "{red}%s{} %d %lu %5.2f %x %c%%\n", "req", -i,
+                    std::uint64_t(1) << 40, 2.5, 255u, 'z');
+    }
+    const std::string name{"session"};
+    CONCOL_BINLOG(log, "{+green}%-8s|{} %lld\n", name, -7LL);
+  }
+  const auto data = read_file(path);
+
+  color::set_enabled(false);
+  const auto plain = decode(data);
+  check(plain ==
+            "req 0 1099511627776  2.50 ff z%\n"
+            "req -1 1099511627776  2.50 ff z%\n"
+            "session | -7\n",
+        "plain decode");
+
+  // A corrupt definition id is skipped instead of sizing the table by it.
+  auto corrupt = data;
+  for (std::size_t pos{binary_log::header_size}; pos + 8 <= corrupt.size();) {
+    std::uint32_t id{}, record_size{};
+    std::memcpy(&id, &corrupt[pos], 4);
+    std::memcpy(&record_size, &corrupt[pos + 4], 4);
+    if (id == 0 && record_size == 0) break;
+    if ((id & binary_log::define_flag) != 0) {
+      id = binary_log::define_flag | 0x7FFFFFFE;
+      std::memcpy(&corrupt[pos], &id, 4);
+      break;
+    }
+    pos += (8 + record_size + 7) & ~std::size_t(7);
+  }
+  check(decode(corrupt) == "session | -7\n", "corrupt format id");
+
+  // %n and `*` widths never reach snprintf: they are copied through.
+  {
+    binary_log log{path, 1 << 12};
+    int written{};
+    CONCOL_BINLOG(log, "value %n|%d\n", &written, 3);
+    CONCOL_BINLOG(log, "[%*d] %.*f %u\n", 4, 7, 2, 1.5, 9u);
+  }
+  check(decode(read_file(path)) == "value %n|3\n[%*d] %.*f 9\n",
+        "unsafe conversions are copied");
+
+  color::set_enabled(true);
+  const auto colored = decode(data);
+  check(colored.compare(0, 15, "\x1b[0;31mreq\x1b[0m ") == 0,
+        "colored decode");
+  check(colored.find("\x1b[0;32;1msession |\x1b[0m -7\n") != std::string::npos,
+        "bright tag");
+
+  {
+    binary_log log{path, 256};
+    constexpr int threads{4};
+    std::vector<std::thread> writers{};
+    for (int t = 0; t < threads; ++t) {
+      writers.emplace_back([&log, t] {
+        for (int i = 0; i < 100; ++i) {
+          CONCOL_BINLOG(log, "%d:%d\n", t, i);
+        }
+      });
+    }
+    for (auto& writer : writers) writer.join();
+    check(log.dropped() > 0 && log.size() <= 256, "full log drops");
+  }
+  color::set_enabled(false);
+  const auto full = decode(read_file(path));
+  check(!full.empty() && full.back() == '\n', "full log decodes");
+  std::remove(path);
+
+  bool thrown{};
+  try {
+    decode({'x'});
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  check(thrown, "bad header");
+#endif
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,135 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "concol_deferred.h"
+
+using namespace concol;
+
+namespace {
+
+std::string read_all(std::FILE* stream) {
+  std::string str(static_cast<std::size_t>(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  str.resize(std::fread(&str[0], 1, str.size(), stream));
+  return str;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+  color::set_enabled(true);
+
+  deferred_printer printer{64};
+  check(!printer.printf("{red}idle %d{}\n", 1), "nothing queued while idle");
+
+  printer.start();
+  check(printer.printf("{red}%s %d %.1f{}\n", "value", 42, 1.5),
+        "queued while running");
+  // Class arguments are rejected at compile time, since they would reach
+  // vsnprintf through C varargs:
+  //   printer.printf("%s\n", std::string_view{"value"});  // static_assert
+  printer.stop();
+  auto str = read_all(stream);
+  check(str == "\x1b[0;31mvalue 42 1.5\x1b[0m\n", "rendered on drain");
+
+  std::rewind(stream);
+  color::set_enabled(false);
+  constexpr int threads{4};
+  constexpr int messages{2000};
+  printer.start();
+  std::vector<std::thread> producers{};
+  for (int t = 0; t < threads; ++t) {
+    producers.emplace_back([&printer, t] {
+      for (int i = 0; i < messages; ++i) {
+        while (!printer.printf("{green}%d:%d{}\n", t, i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& producer : producers) producer.join();
+  printer.stop();
+  std::fflush(stream);
+  str = read_all(stream);
+
+  std::vector<int> next(threads, 0);
+  std::size_t lines{};
+  bool ordered{true};
+  for (std::size_t pos = 0; pos < str.size();) {
+    const auto end = str.find('\n', pos);
+    if (end == std::string::npos) break;
+    int t{}, i{};
+    if (std::sscanf(str.c_str() + pos, "%d:%d", &t, &i) == 2 && t >= 0 &&
+        t < threads) {
+      ordered = ordered && i == next[t]++;
+    }
+    ++lines;
+    pos = end + 1;
+  }
+  check(lines == threads * messages, "every message is written");
+  check(ordered, "per-producer order is kept");
+
+  // Producers still queueing while stop() runs: every accepted record is
+  // written, none is left in the ring.
+  std::rewind(stream);
+  printer.start();
+  std::atomic<bool> done{};
+  std::atomic<std::size_t> accepted{};
+  producers.clear();
+  for (int t = 0; t < threads; ++t) {
+    producers.emplace_back([&] {
+      while (!done.load()) {
+        if (printer.printf("x\n")) accepted.fetch_add(1);
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  printer.stop();
+  done.store(true);
+  for (auto& producer : producers) producer.join();
+  std::fflush(stream);
+  lines = 0;
+  for (const auto ch : read_all(stream)) lines += (ch == '\n') ? 1 : 0;
+  check(accepted.load() != 0 && lines == accepted.load(),
+        "stop() waits for in-flight records");
+  color::set_ostream(stdout);
+  std::fclose(stream);
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
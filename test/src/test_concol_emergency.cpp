@@ -0,0 +1,95 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_emergency.h"
+
+using namespace concol;
+
+namespace {
+
+std::string read_all(std::FILE* stream) {
+  std::fseek(stream, 0, SEEK_END);
+  std::string str(static_cast<std::size_t>(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  str.resize(std::fread(&str[0], 1, str.size(), stream));
+  return str;
+}
+
+int signal_fd{-1};
+
+extern "C" void on_signal(int signal) {
+  emergency_printf(signal_fd, "{+red}caught signal %d{}\n", signal);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  std::FILE* stream = std::tmpfile();
+  const int fd{fileno(stream)};
+  color::set_enabled(true);
+
+  emergency_printf(fd, "{red}%s{} %d %u %x %X %lld %c %p %% {nope}\n", "err",
+                   -42, 7u, 255, 255u, -9000000000LL, 'q',
+                   reinterpret_cast<const void*>(0x1f));
+  check(read_all(stream) ==
+            "\x1b[0;31merr\x1b[0m -42 7 ff FF -9000000000 q 0x1f % {nope}\n",
+        "conversions and tags");
+
+  std::fclose(stream);
+  stream = std::tmpfile();
+  color::set_enabled(false);
+  emergency_printf(fileno(stream), "[%5d|%-5s|%05d|%-4x]%d\n", 42, "ab", -42,
+                   10u);
+  check(read_all(stream) == "[   42|ab   |-0042|a   ]%d\n",
+        "width, flags and missing arguments");
+
+  std::fclose(stream);
+  stream = std::tmpfile();
+  const std::string long_text(2000, 'x');
+  emergency_printf(fileno(stream), "%s!", long_text.c_str());
+  check(read_all(stream) == long_text + '!', "output larger than the buffer");
+
+  std::fclose(stream);
+  stream = std::tmpfile();
+  signal_fd = fileno(stream);
+  color::set_enabled(true);
+  std::signal(SIGTERM, on_signal);
+  std::raise(SIGTERM);
+  std::signal(SIGTERM, SIG_DFL);
+  check(read_all(stream) == "\x1b[0;31;1mcaught signal 15\x1b[0m\n",
+        "signal handler");
+  std::fclose(stream);
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
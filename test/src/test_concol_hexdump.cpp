@@ -0,0 +1,153 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "concol_hexdump.h"
+#include "concol_text.h"
+
+using namespace concol;
+
+namespace {
+
+std::string escape(const char* tag) {
+  std::string out{};
+  color::append_parsed(out, tag, std::string{tag}.size());
+  return out;
+}
+
+std::string render(const std::vector<unsigned char>& bytes,
+                   std::uint64_t offset = 0) {
+  std::string out{};
+  hexdump_renderer{}.render(bytes.data(), bytes.size(), out, offset);
+  return out;
+}
+
+// hexdump -Cv, one byte at a time.
+std::string reference(const std::vector<unsigned char>& bytes) {
+  std::string out{};
+  char buf[32]{};
+  for (std::size_t line{}; line < bytes.size(); line += 16) {
+    std::snprintf(buf, sizeof(buf), "%08zx  ", line);
+    out += buf;
+    std::string chars{};
+    for (std::size_t i{}; i < 16; ++i) {
+      if (line + i < bytes.size()) {
+        const auto byte = bytes[line + i];
+        std::snprintf(buf, sizeof(buf), "%02x ", byte);
+        out += buf;
+        chars += (byte >= 0x20 && byte < 0x7F) ? char(byte) : '.';
+      } else {
+        out += "   ";
+      }
+      if (i == 7) out += ' ';
+    }
+    out += " |" + chars + "|\n";
+  }
+  return out;
+}
+
+std::size_t count_escapes(const std::string& str) {
+  std::size_t count{};
+  for (const auto ch : str) count += (ch == '\x1b') ? 1 : 0;
+  return count;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  const std::string text{"Hello world\n"};
+  std::vector<unsigned char> hello{text.begin(), text.end()};
+  for (const unsigned char byte : {0, 0, 0, 0, 1, 2, 0xFF, 0xFE, 0x41, 0x42}) {
+    hello.push_back(byte);
+  }
+
+  std::vector<unsigned char> all{};
+  for (unsigned i{}; i < 1000; ++i) all.push_back((i * 37 + i / 256) & 0xFF);
+
+  color::set_enabled(false);
+  check(render(hello) ==
+            "00000000  48 65 6c 6c 6f 20 77 6f  72 6c 64 0a 00 00 00 00  "
+            "|Hello world.....|\n"
+            "00000010  01 02 ff fe 41 42                                 "
+            "|....AB|\n",
+        "hexdump -Cv layout");
+
+  const auto plain = render(all);
+  check(plain == reference(all), "every byte value");
+  check(render({}).empty(), "empty input");
+  check(render({'x'}, 0x100000000u) ==
+            "0000000100000000  78" + std::string(47, ' ') + " |x|\n",
+        "wide offsets");
+
+  color::set_enabled(true);
+  const auto reset = std::string{color::ansi_color_reset()};
+  const auto cyan = escape("{cyan}");
+  const auto gray = escape("{+black}");
+  check(render({'A', 0, 0, 'B'}) ==
+            "00000000  " + cyan + "41 " + gray + "00 00 " + cyan + "42 " +
+                reset + std::string(37, ' ') + " |" + cyan + "A" + gray +
+                ".." + cyan + "B" + reset + "|\n",
+        "styles change with the class");
+
+  // A run of one class costs one escape and one reset per column.
+  const std::vector<unsigned char> zeros(64 * 1024);
+  check(count_escapes(render(zeros)) == zeros.size() / 16 * 4,
+        "no redundant escapes");
+
+  check(strip_ansi(render(all)) == plain, "colors only add escapes");
+  hexdump_styles stacked{};
+  stacked.printable = "{red}{+blue}{cyan}";
+  std::string out{};
+  hexdump_renderer{stacked}.render(all.data(), all.size(), out);
+  check(strip_ansi(out) == plain, "escapes longer than a slot");
+
+  hexdump_styles unstyled{};
+  unstyled.printable.clear();
+  out.clear();
+  hexdump_renderer{unstyled}.render(hello.data(), 2, out);
+  check(count_escapes(out) == 0, "unstyled class");
+
+  hexdump_renderer renderer{};
+  check(renderer.class_of('\n') == byte_class::control, "default class");
+  renderer.set_class('\n', byte_class::printable);
+  check(renderer.class_of('\n') == byte_class::printable, "set_class");
+
+  // Rendering in pieces that end on a line boundary changes nothing.
+  out.clear();
+  renderer = hexdump_renderer{};
+  renderer.render(all.data(), 512, out);
+  renderer.render(all.data() + 512, all.size() - 512, out, 512);
+  check(out == render(all), "rendered in pieces");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,140 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_highlight.h"
+
+using namespace concol;
+
+namespace {
+
+std::string styled(const char* tag, const std::string& text) {
+  return color::to_string((std::string{tag} + "%s{}").c_str(), text.c_str());
+}
+
+std::string key(const std::string& text) { return styled("{cyan}", text); }
+
+std::string highlight(const std::string& input,
+                      highlight_format format = highlight_format::automatic) {
+  std::string out{};
+  structured_highlighter highlighter{format};
+  highlighter.feed(input, out);
+  highlighter.finish(out);
+  return out;
+}
+
+// The same input fed one byte at a time.
+std::string highlight_bytes(const std::string& input) {
+  std::string out{};
+  structured_highlighter highlighter{};
+  for (const auto ch : input) highlighter.feed(std::string_view{&ch, 1}, out);
+  highlighter.finish(out);
+  return out;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  color::set_enabled(true);
+
+  const std::string json{
+      "{\"level\":\"error\",\"msg\":\"a \\\"quoted\\\" word\",\"n\":-4.5e+3,"
+      "\"ok\":true,\"none\":null}\n"};
+  check(highlight(json) ==
+            "{" + key("\"level\"") + ":" + styled("{+red}", "\"error\"") +
+                "," + key("\"msg\"") + ":" +
+                styled("{green}", "\"a \\\"quoted\\\" word\"") + "," +
+                key("\"n\"") + ":" + styled("{yellow}", "-4.5e+3") + "," +
+                key("\"ok\"") + ":" + styled("{magenta}", "true") + "," +
+                key("\"none\"") + ":" + styled("{magenta}", "null") + "}\n",
+        "json line");
+
+  check(highlight("{\"a\":[1,{\"b\":\"c\"}],\"d\":{}}\n") ==
+            "{" + key("\"a\"") + ":[" + styled("{yellow}", "1") + ",{" +
+                key("\"b\"") + ":" + styled("{green}", "\"c\"") + "}]," +
+                key("\"d\"") + ":{}}\n",
+        "nested containers");
+
+  check(highlight("{\"level\":50}\n{\"lvl\":\"WARNING\"}\n") ==
+            "{" + key("\"level\"") + ":" + styled("{+red}", "50") + "}\n{" +
+                key("\"lvl\"") + ":" + styled("{+yellow}", "\"WARNING\"") +
+                "}\n",
+        "level values");
+
+  check(highlight("{\n  \"a\": 1\n}\n") ==
+            "{\n  " + key("\"a\"") + ": " + styled("{yellow}", "1") + "\n}\n",
+        "multi-line json");
+
+  const std::string logfmt{
+      "ts=2024-01-01T10:00:00Z level=warn msg=\"disk full\" used=97.5 "
+      "retry=false see docs\n"};
+  check(highlight(logfmt) ==
+            key("ts") + "=2024-01-01T10:00:00Z " + key("level") + "=" +
+                styled("{+yellow}", "warn") + " " + key("msg") + "=" +
+                styled("{green}", "\"disk full\"") + " " + key("used") +
+                "=" + styled("{yellow}", "97.5") + " " + key("retry") + "=" +
+                styled("{magenta}", "false") + " see docs\n",
+        "logfmt line");
+
+  check(highlight("[1]\n", highlight_format::logfmt) == "[1]\n",
+        "forced logfmt");
+  check(highlight("{\"open\":\"cut") ==
+            "{" + key("\"open\"") + ":" + styled("{green}", "\"cut"),
+        "unfinished string is closed");
+
+  const auto mixed = json + logfmt + "{\"a\":{\"level\":\"debug\"}}\n" +
+                     "plain text = odd\n" + json;
+  check(highlight_bytes(mixed) == highlight(mixed), "chunk boundaries");
+
+  const std::string long_value(1000, 'v');
+  const auto long_line = "key=" + long_value + " level=" + long_value + "\n";
+  check(highlight_bytes(long_line) == highlight(long_line),
+        "tokens longer than max_pending");
+
+  color::set_enabled(false);
+  check(highlight(mixed) == mixed, "disabled colors keep the input");
+  color::set_enabled(true);
+
+  std::FILE* in = std::tmpfile();
+  std::FILE* out = std::tmpfile();
+  std::fputs(logfmt.c_str(), in);
+  std::rewind(in);
+  highlight_stream(in, out);
+  std::rewind(out);
+  std::string streamed(4096, '\0');
+  streamed.resize(std::fread(&streamed[0], 1, streamed.size(), out));
+  check(streamed == highlight(logfmt), "highlight_stream");
+  std::fclose(in);
+  std::fclose(out);
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
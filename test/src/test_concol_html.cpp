@@ -0,0 +1,135 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_html.h"
+
+using namespace concol;
+
+namespace {
+
+std::string convert(const std::string& str, text_format format) {
+  html_converter converter{format};
+  std::string out{};
+  converter.feed(str, out);
+  converter.finish(out);
+  return out;
+}
+
+std::string read_all(std::FILE* stream) {
+  std::string str(static_cast<std::size_t>(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  str.resize(std::fread(&str[0], 1, str.size(), stream));
+  return str;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  check(convert("a<b> & \"c\"", text_format::ansi) ==
+            "a&lt;b&gt; &amp; &quot;c&quot;",
+        "escaping");
+
+  const std::string ansi{
+      "\x1b[0;31;1mERROR\x1b[0m \x1b[0;31;1m<x>\x1b[0m\x1b[0;31;1m!\x1b[0m "
+      "\x1b[34;42mbg\x1b[39m.\x1b[0m\x1b[K\x1b]8;;u\x1b\\link\n"};
+  const std::string html{
+      "<span class=\"cc-fg-red cc-bold\">ERROR</span> "
+      "<span class=\"cc-fg-red cc-bold\">&lt;x&gt;!</span> "
+      "<span class=\"cc-fg-blue cc-bg-green\">bg</span>"
+      "<span class=\"cc-bg-green\">.</span>link\n"};
+  check(convert(ansi, text_format::ansi) == html, "ansi spans");
+
+  bool split{true};
+  for (std::size_t cut{}; cut <= ansi.size(); ++cut) {
+    html_converter converter{};
+    std::string out{};
+    converter.feed(std::string_view{ansi}.substr(0, cut), out);
+    converter.feed(std::string_view{ansi}.substr(cut), out);
+    converter.finish(out);
+    split = split && out == html;
+  }
+  check(split, "sequences split across chunks");
+
+  const std::string markup{"{+red}ERROR{} {green}ok{}{green} too{} {x} {"};
+  const std::string markup_html{
+      "<span class=\"cc-fg-red cc-bold\">ERROR</span> "
+      "<span class=\"cc-fg-green\">ok too</span> {x} {"};
+  check(convert(markup, text_format::markup) == markup_html, "markup spans");
+  split = true;
+  for (std::size_t cut{}; cut <= markup.size(); ++cut) {
+    html_converter converter{text_format::markup};
+    std::string out{};
+    converter.feed(std::string_view{markup}.substr(0, cut), out);
+    converter.feed(std::string_view{markup}.substr(cut), out);
+    converter.finish(out);
+    split = split && out == markup_html;
+  }
+  check(split, "tags split across chunks");
+
+  const std::string open_brace{"{" + std::string(300, 'x') + "{red}y"};
+  check(convert(open_brace, text_format::markup) ==
+            "{" + std::string(300, 'x') + "<span class=\"cc-fg-red\">y</span>",
+        "unterminated brace is text");
+
+  theme{}.set("path", color_type::cyan, color_type::blue).apply();
+  check(convert("{path}/tmp{}", text_format::markup) ==
+            "<span class=\"cc-fg-cyan cc-bg-blue\">/tmp</span>",
+        "theme tags");
+  theme::clear();
+
+  std::FILE* in = std::tmpfile();
+  std::FILE* out = std::tmpfile();
+  for (int i = 0; i < 20000; ++i) {
+    std::fputs("\x1b[0;32mPASS\x1b[0m test\n", in);
+  }
+  std::rewind(in);
+  write_html(in, out);
+  const auto document = read_all(out);
+  std::fclose(in);
+  std::fclose(out);
+  check(document.compare(0, 15, "<!DOCTYPE html>") == 0 &&
+            document.find(".cc-fg-green{") != std::string::npos,
+        "document with stylesheet");
+  std::size_t spans{};
+  for (auto pos = document.find("<span"); pos != std::string::npos;
+       pos = document.find("<span", pos + 1)) {
+    ++spans;
+  }
+  check(spans == 20000, "every chunk converted");
+  check(document.size() > 21 &&
+            document.compare(document.size() - 21, 21,
+                             "</pre></body></html>\n") == 0,
+        "document closed");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,86 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#define CONCOL_LOG_LEVEL CONCOL_LOG_LEVEL_INFO
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_log.h"
+
+using namespace concol;
+
+namespace {
+
+int evaluated{};
+
+int touch() { return ++evaluated; }
+
+std::string read_all(std::FILE* stream) {
+  std::string str(std::size_t(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  auto size = std::fread(&str[0], 1, str.size(), stream);
+  str.resize(size);
+  return str;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+
+  CONCOL_LOG_TRACE("trace %d", touch());
+  CONCOL_LOG_DEBUG("debug %d", touch());
+  check(evaluated == 0, "compiled-out levels do not evaluate arguments");
+
+  logger::set_level(log_level::warn);
+  CONCOL_LOG_INFO("info %d", touch());
+  check(evaluated == 0, "runtime-disabled levels do not evaluate arguments");
+
+  CONCOL_LOG_WARN("disk {+cyan}%s{} is %d%% full", "/var", 93);
+  color::set_enabled(true);
+  CONCOL_LOG_ERROR("no arguments");
+  color::set_enabled(false);
+  CONCOL_LOG_ERROR("%s", std::string(1000, 'x').c_str());
+
+  auto str = read_all(stream);
+  color::set_ostream(stdout);
+  std::fclose(stream);
+
+  check(str.find("WARN  disk /var is 93% full\n") == 0, "plain line");
+  check(str.find("\x1b[0;31;1mERROR\x1b[0m no arguments\n") !=
+            std::string::npos,
+        "colored prefix");
+  check(str.size() > 1000 && str.compare(str.size() - 2, 2, "x\n") == 0,
+        "long line is not truncated");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
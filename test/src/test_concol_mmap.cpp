@@ -0,0 +1,141 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "check.h"
+#include "concol_mmap.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+namespace {
+
+std::string read_file(const std::string& path) {
+  std::ifstream file{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file},
+          std::istreambuf_iterator<char>{}};
+}
+
+bool exists(const std::string& path) {
+  return std::ifstream{path}.good();
+}
+
+bool whole_lines(const std::string& str) {
+  return !str.empty() && str.compare(0, 4, "line") == 0 &&
+         str.back() == '\n';
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  const std::string zeros(20, '\0');
+  check(detail::recover_length(zeros.data(), zeros.size()) == 0,
+        "only padding");
+  check(detail::recover_length("a\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16) == 1,
+        "one byte");
+  check(detail::recover_length("abcdefghijklmnopq", 17) == 17, "no padding");
+  check(detail::recover_length("abcdefgh\0\0\0\0\0\0\0\0\0", 17) == 8,
+        "aligned padding");
+
+#ifndef _WIN32
+  char dir_template[]{"/tmp/test_concol_mmap_XXXXXX"};
+  const std::string dir{::mkdtemp(dir_template)};
+  color::set_enabled(true);
+
+  const auto path = dir + "/colored.log";
+  std::string expected{};
+  {
+    mmap_sink sink{path, 4096, 2};
+    sink.install();
+    color::printf("{red}first{} %d\n", 1);
+    color::write("second\n", 7);
+    expected = color::to_string("{red}first{} %d\n", 1) + "second\n";
+    check(sink.size() == expected.size(), "size");
+    const std::string large(5000, 'x');
+    color::write(large.data(), large.size());
+    check(sink.dropped() == 1, "message larger than the file");
+  }
+  check(color::get_sink() == nullptr, "uninstalled by the destructor");
+  check(read_file(path) == expected, "truncated to the contents");
+
+  {
+    mmap_sink sink{path, 4096, 2, true};
+    sink.install();
+    color::printf("{+green}stripped{} text\n");
+  }
+  expected += "stripped text\n";
+  check(read_file(path) == expected, "appended and stripped");
+
+  const auto rotated = dir + "/rotated.log";
+  {
+    mmap_sink sink{rotated, 4096, 2};
+    sink.set_sync_interval(512);
+    const std::string line = "line " + std::string(94, '-') + '\n';
+    for (int i = 0; i < 100; ++i) sink.write(line.data(), line.size());
+    check(sink.size() % line.size() == 0, "current file holds whole lines");
+  }
+  const auto current = read_file(rotated);
+  const auto first = read_file(rotated + ".1");
+  const auto second = read_file(rotated + ".2");
+  check(whole_lines(current) && current.size() <= 4096, "current file");
+  check(whole_lines(first) && first.size() == 4000, "first rotated file");
+  check(whole_lines(second) && second.size() == 4000, "second rotated file");
+  check(!exists(rotated + ".3"), "rotated file limit");
+
+  // A crash leaves the file at its mapped size, padded with zeros.
+  const auto crashed = dir + "/crashed.log";
+  {
+    std::ofstream file{crashed, std::ios::binary};
+    file << "line one\nline tw" << std::string(1000, '\0');
+  }
+  {
+    mmap_sink sink{crashed, 4096};
+    check(sink.size() == 17, "recovered length and a closing newline");
+    sink.write("line three\n", 11);
+  }
+  check(read_file(crashed) == "line one\nline tw\nline three\n",
+        "appended after the recovered contents");
+
+  for (const auto& file :
+       {path, rotated, rotated + ".1", rotated + ".2", crashed}) {
+    std::remove(file.c_str());
+  }
+  ::rmdir(dir.c_str());
+#endif
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,137 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "check.h"
+#include "concol_mux.h"
+
+using namespace concol;
+
+namespace {
+
+constexpr const char* padding{" padded with enough text to make the pipe busy"};
+
+
+std::string read_all(std::FILE* stream) {
+  std::string str(static_cast<std::size_t>(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  str.resize(std::fread(&str[0], 1, str.size(), stream));
+  return str;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+#ifdef __linux__
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+  color::set_enabled(false);
+  {
+    output_mux mux{};
+    constexpr int children{40};
+    constexpr int lines{200};
+    std::vector<int> pids{};
+    for (int i = 0; i < children; ++i) {
+      const auto name = "job" + std::to_string(i);
+      pids.push_back(mux.spawn(
+          "i=0; while [ $i -lt " + std::to_string(lines) +
+              " ]; do echo \"line $i of " + name + padding + "\"; "
+              "i=$((i+1)); done; printf tail",
+          name, color_type(i % 16)));
+    }
+    check(mux.size() == children, "children adopted");
+    mux.run();
+    check(mux.size() == 0, "all children finished");
+    bool exited{true};
+    for (auto pid : pids) {
+      int status{};
+      exited = exited && ::waitpid(pid, &status, 0) == pid &&
+               WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    check(exited, "children exit cleanly");
+  }
+  const auto str = read_all(stream);
+
+  std::map<std::string, int> next{};
+  bool whole{true};
+  std::size_t count{};
+  for (std::size_t pos = 0; pos < str.size();) {
+    const auto end = str.find('\n', pos);
+    const auto line = str.substr(pos, end - pos);
+    pos = end + 1;
+    ++count;
+    const auto bar = line.find(" | ");
+    if (bar == std::string::npos) {
+      whole = false;
+      continue;
+    }
+    const auto name = line.substr(0, bar);
+    const auto text = line.substr(bar + 3);
+    if (text == "tail") {
+      whole = whole && next[name] == 200;
+      continue;
+    }
+    const auto expected = "line " + std::to_string(next[name]++) + " of " +
+                          name + padding;
+    whole = whole && text == expected;
+  }
+  check(count == 40 * 201, "every line written");
+  check(whole, "lines are whole, prefixed and in order per child");
+
+  std::rewind(stream);
+  color::set_enabled(true);
+  int fds[2];
+  check(::pipe(fds) == 0, "pipe");
+  {
+    output_mux mux{};
+    mux.adopt(fds[0], "cc", color_type::red_bright);
+    check(::write(fds[1], "a\nb", 3) == 3, "write");
+    mux.poll(1000);
+    ::close(fds[1]);
+    mux.run();
+  }
+  std::fflush(stream);
+  check(read_all(stream) ==
+            "\x1b[0;31;1mcc\x1b[0m | a\n\x1b[0;31;1mcc\x1b[0m | b\n",
+        "colored prefix and partial line at end of file");
+  color::set_ostream(stdout);
+  std::fclose(stream);
+#endif
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
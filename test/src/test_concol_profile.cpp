@@ -0,0 +1,149 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef CONCOL_PROFILE
+#define CONCOL_PROFILE
+#endif
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_profile.h"
+
+using namespace concol;
+
+namespace {
+
+std::string read_all(std::FILE* stream) {
+  std::string out{};
+  std::rewind(stream);
+  char buffer[4096];
+  std::size_t size{};
+  while ((size = std::fread(buffer, 1, sizeof(buffer), stream)) != 0) {
+    out.append(buffer, size);
+  }
+  return out;
+}
+
+const callsite_profile* find_site(int line) {
+  const callsite_profile* found{};
+  callsite_profile::for_each([&](const callsite_profile& site) {
+    if (site.line() == line) found = &site;
+  });
+  return found;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  bool bounded{true};
+  for (std::uint64_t value = 0; value < 1000000; value = value * 3 / 2 + 1) {
+    const auto limit = latency_histogram::bucket_limit(
+        latency_histogram::bucket_index(value));
+    bounded = bounded && limit >= value && limit <= value + value / 8;
+  }
+  check(bounded, "bucket limits within 12.5%");
+  check(latency_histogram::bucket_index(std::uint64_t(1) << 60) ==
+            latency_histogram::bucket_count - 1,
+        "long values in the last bucket");
+
+  latency_histogram histogram{};
+  for (std::uint64_t value = 1; value <= 1000; ++value) {
+    histogram.record(value);
+  }
+  check(histogram.count() == 1000 && histogram.total() == 500500, "totals");
+  check(histogram.percentile(0.5) >= 500 && histogram.percentile(0.5) <= 563,
+        "median");
+  check(histogram.percentile(1.0) >= 1000, "maximum");
+
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+  color::set_enabled(true);
+  const int printf_line = __LINE__ + 2;
+  for (int i = 0; i < 10; ++i) {
+    CONCOL_PROFILE_PRINTF("{red}value{} %d\n", i);
+  }
+  const std::string long_text(1000, 'x');
+  const int long_line = __LINE__ + 1;
+  CONCOL_PROFILE_PRINTF("{green}%s{}\n", long_text.c_str());
+  const int print_line = __LINE__ + 1;
+  CONCOL_PROFILE_PRINT(color{"print"}.print_blue());
+  color::set_ostream(stdout);
+
+  std::string expected{};
+  for (int i = 0; i < 10; ++i) {
+    expected += color::to_string("{red}value{} %d\n", i);
+  }
+  expected += color::to_string("{green}%s{}\n", long_text.c_str());
+  expected += color::to_string("{blue}print{}");
+  check(read_all(stream) == expected, "same output as color::printf");
+  std::fclose(stream);
+
+  const auto site = find_site(printf_line);
+  check(site != nullptr && site->calls() == 10, "printf site calls");
+  check(site != nullptr &&
+            site->bytes() == expected.find("\x1b[0;32m"),
+        "printf site bytes");
+  check(site != nullptr &&
+            site->phase(profile_phase::write).count() == 10,
+        "phase histograms");
+  const auto print_site = find_site(print_line);
+  check(print_site != nullptr && print_site->calls() == 1,
+        "print site calls");
+
+  std::FILE* report = std::tmpfile();
+  callsite_profile::report(report, 2, profile_order::bytes);
+  const auto text = read_all(report);
+  std::fclose(report);
+  const auto first = text.find("test_concol_profile.cpp:" +
+                               std::to_string(long_line));
+  const auto second = text.find("test_concol_profile.cpp:" +
+                                std::to_string(printf_line));
+  check(first != std::string::npos && second != std::string::npos &&
+            first < second,
+        "report ordered by bytes");
+  check(text.find(":" + std::to_string(print_line)) == std::string::npos,
+        "report limited to the top sites");
+
+  callsite_profile::reset_all();
+  check(site != nullptr && site->calls() == 0 && site->total_ns() == 0,
+        "reset");
+
+  // A site that is not a function-local static leaves the list with its
+  // scope, so report() and reset_all() never see a dangling node.
+  {
+    callsite_profile scoped{"scoped.cpp", -1};
+    check(find_site(-1) == &scoped, "scoped site registered");
+  }
+  check(find_site(-1) == nullptr, "scoped site unlinked");
+  callsite_profile::reset_all();
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
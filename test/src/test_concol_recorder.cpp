@@ -0,0 +1,89 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_log.h"
+#include "concol_recorder.h"
+
+using namespace concol;
+
+namespace {
+
+std::string read_all(std::FILE* stream) {
+  std::string str(static_cast<std::size_t>(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  str.resize(std::fread(&str[0], 1, str.size(), stream));
+  return str;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+  color::set_enabled(true);
+  {
+    flight_recorder recorder{64};
+    recorder.install();
+    check(recorder.capacity() == 64 && recorder.size() == 0, "empty");
+    color::printf("{red}%s{}\n", "first");
+    check(recorder.snapshot() == "\x1b[0;31mfirst\x1b[0m\n", "colored copy");
+    check(read_all(stream) == recorder.snapshot(), "stream gets the same");
+    for (int i = 0; i < 20; ++i) color::printf("line %02d\n", i);
+    const auto str = recorder.snapshot();
+    check(str.size() <= 64 && str.compare(0, 5, "line ") == 0,
+          "wrapped copy starts at a line");
+    check(str.size() >= 8 && str.compare(str.size() - 8, 8, "line 19\n") == 0,
+          "newest line is kept");
+    check(recorder.size() == str.size(), "size");
+  }
+  check(color::get_tee() == nullptr, "uninstalled on destruction");
+
+  flight_recorder plain{256, false};
+  plain.install();
+  color::printf(std::string_view{"{+green}ok{} done\n"});
+  logger::set_level(log_level::info);
+  CONCOL_LOG_WARN("disk %d%%", 91);
+  check(plain.snapshot() == "ok done\nWARN  disk 91%\n", "plain copy");
+
+  std::FILE* dump = std::tmpfile();
+  plain.dump(fileno(dump));
+  std::fseek(dump, 0, SEEK_END);
+  check(read_all(dump) == plain.snapshot(), "dump");
+  std::fclose(dump);
+
+  color::set_tee();
+  color::set_ostream(stdout);
+  std::fclose(stream);
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
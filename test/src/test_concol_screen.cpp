@@ -0,0 +1,86 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+
+#include "check.h"
+#include "concol_screen.h"
+
+using namespace concol;
+
+namespace {
+
+void draw(screen& scr, int frame) {
+  char text[64];
+  for (std::size_t y{}; y < scr.height(); ++y) {
+    for (std::size_t x{}; x + 20 <= scr.width(); x += 20) {
+      std::snprintf(text, sizeof(text), "{+cyan}m%02zu{} {+green}%6d{}", y,
+                    int(x * y) + ((x == 0 && y < 4) ? frame : 0));
+      scr.print(x, y, text);
+    }
+  }
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  color::set_enabled(true);
+  screen scr{200, 60};
+
+  std::string out{};
+  draw(scr, 0);
+  scr.render(out);
+  const auto full_size = out.size();
+  check(full_size > 12000, "first frame is drawn in full");
+
+  out.clear();
+  draw(scr, 0);
+  scr.render(out);
+  check(out.empty(), "unchanged frame sends nothing");
+
+  out.clear();
+  draw(scr, 7);
+  scr.render(out);
+  check(!out.empty() && out.size() < 200, "small change sends a small diff");
+
+  scr.clear();
+  scr.print(0, 0, "\xE6\x97\xA5x");
+  check(scr.at(0, 0).ch == 0x65E5 && scr.at(1, 0).ch == 0 &&
+            scr.at(2, 0).ch == U'x',
+        "wide character takes two cells");
+  scr.put(1, 0, U'y');
+  check(scr.at(0, 0).ch == U' ', "overwriting half a wide character");
+
+  scr.invalidate();
+  out.clear();
+  scr.render(out);
+  check(out.size() >= 200 * 60, "invalidate forces a full frame");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
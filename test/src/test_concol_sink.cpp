@@ -0,0 +1,133 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_sink.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+namespace {
+
+#ifndef _WIN32
+std::string read_available(int fd) {
+  std::string out{};
+  char buffer[4096];
+  for (;;) {
+    const auto size = ::read(fd, buffer, sizeof(buffer));
+    if (size <= 0) break;
+    out.append(buffer, std::size_t(size));
+  }
+  return out;
+}
+#endif
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+#ifndef _WIN32
+  ::signal(SIGPIPE, SIG_IGN);
+  int fds[2];
+  check(::pipe(fds) == 0, "pipe");
+  ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  ::fcntl(fds[1], F_SETFL, ::fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+  // Fill the pipe so that the sink has to buffer.
+  std::size_t filler{};
+  const std::string block(4096, 'x');
+  for (;;) {
+    const auto size = ::write(fds[1], block.data(), block.size());
+    if (size <= 0) {
+      if (::write(fds[1], block.data(), 1) <= 0) break;
+      ++filler;
+      continue;
+    }
+    filler += std::size_t(size);
+  }
+
+  color::set_enabled(true);
+  const std::string text(48, 'a');
+  std::string expected{};
+  {
+    fd_sink sink{fds[1], 256};
+    std::size_t callbacks{};
+    std::size_t reported{};
+    sink.set_high_watermark(100, [&](std::size_t pending) {
+      ++callbacks;
+      reported = pending;
+    });
+    sink.install();
+    check(color::get_sink() == &sink, "installed");
+
+    for (int i = 0; i < 5; ++i) {
+      color::printf("{red}%s %d{}\n", text.c_str(), i);
+    }
+    // 4 messages of 62 bytes fit into 256, the fifth is dropped whole.
+    for (int i = 0; i < 4; ++i) {
+      expected += color::to_string("{red}%s %d{}\n", text.c_str(), i);
+    }
+    check(sink.pending() == expected.size(), "pending bytes");
+    check(sink.dropped() == 1, "message dropped");
+    check(callbacks == 1, "high watermark reported once");
+    check(reported > 100 && reported <= 256, "pending at the watermark");
+
+    check(read_available(fds[0]).size() == filler, "filler");
+    check(sink.flush(1000) == 0, "flushed");
+    check(sink.pending() == 0, "nothing pending");
+
+    color::printf("{green}after{}\n");
+    expected += "\x1b[0m";
+    expected += color::to_string("{green}after{}\n");
+    check(read_available(fds[0]) == expected,
+          "whole messages and a reset after the drop");
+
+    color::write("direct\n", 7);
+    check(read_available(fds[0]) == "direct\n",
+          "no reset when nothing dropped");
+
+    ::close(fds[0]);
+    color::printf("lost\n");
+    check(sink.error() == EPIPE, "write error");
+    check(sink.dropped() == 2, "failed message dropped");
+  }
+  check(color::get_sink() == nullptr, "uninstalled by the destructor");
+  ::close(fds[1]);
+#endif
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
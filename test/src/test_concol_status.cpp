@@ -0,0 +1,103 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "concol_status.h"
+#include "concol_text.h"
+
+using namespace concol;
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  color::set_enabled(true);
+
+  status_line status{0, 60};
+  auto& build = status.add_bar("build", 100, color_type::green);
+  auto& tests = status.add_bar("tests", 100, color_type::cyan);
+
+  std::string frame{};
+  status.render(frame);
+  check(frame.find("build") != std::string::npos, "first frame has labels");
+  check(frame.find("0/100") != std::string::npos, "first frame has counters");
+  const auto full_size = frame.size();
+
+  frame.clear();
+  status.render(frame);
+  check(frame.empty(), "unchanged frame renders nothing");
+
+  build.add(1);
+  frame.clear();
+  status.render(frame);
+  check(!frame.empty(), "changed frame renders something");
+  check(frame.size() < full_size / 2, "changed frame is a diff");
+  check(frame.find("build") == std::string::npos, "labels are not repainted");
+
+  std::vector<std::thread> workers{};
+  for (int i{}; i < 4; ++i) {
+    workers.emplace_back([&] {
+      for (int n{}; n < 25; ++n) tests.add();
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  check(tests.current() == 100, "concurrent updates are counted");
+
+  status.refresh(true);
+
+  // Labels are measured in columns, not bytes: the bars line up and every
+  // row is as wide as the status line.
+  color::set_enabled(false);
+  status_line wide{0, 40};
+  auto& sized = wide.add_bar("gr\xc3\xb6\xc3\x9f" "e", 10);
+  wide.add_bar("\xe6\xbc\xa2", 10);
+  wide.add_bar("ab", 10);
+  frame.clear();
+  wide.render(frame);
+  std::vector<std::size_t> bar_columns{};
+  bool full_rows{true};
+  for (std::size_t pos{}; pos < frame.size();) {
+    const auto end = frame.find('\n', pos);
+    if (end == std::string::npos) break;
+    auto row = frame.substr(pos, end - pos);
+    if (!row.empty() && row[0] == '\r') row.erase(0, 1);
+    bar_columns.push_back(visible_width(row.substr(0, row.find('['))));
+    full_rows = full_rows && visible_width(row) == 40;
+    pos = end + 1;
+  }
+  check(bar_columns.size() == 3 && bar_columns[0] == 6 &&
+            bar_columns[1] == 6 && bar_columns[2] == 6,
+        "UTF-8 labels keep the bars aligned");
+  check(full_rows, "UTF-8 rows fill the width");
+  sized.add(5);
+  frame.clear();
+  wide.render(frame);
+  check(frame.find("\x1b[8G") != std::string::npos,
+        "repaint column counts UTF-8 labels as columns");
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
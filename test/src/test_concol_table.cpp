@@ -0,0 +1,75 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstring>
+
+#include "check.h"
+#include "concol_table.h"
+
+using namespace concol;
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  color::set_enabled(false);
+  table plain{3};
+  plain.set_align(1, table_align::right);
+  plain.add_row({"name", "size", "note"});
+  plain.add_row({"{red}a{}", "10", "x"});
+  plain.add_row({"\xE6\x97\xA5\xE6\x9C\xAC", "2048"});
+  check(plain.width(0) == 4, "tags and wide characters are measured");
+  check(plain.to_string() ==
+            "name size note\n"
+            "a      10 x\n"
+            "\xE6\x97\xA5\xE6\x9C\xAC 2048 \n",
+        "plain layout");
+
+  color::set_enabled(true);
+  table colored{2};
+  colored.add_row({{"ok", color_type::green}, "{+red}failed{}"});
+  colored.add_row({"longer", "1"});
+  check(colored.width(0) == 6, "escapes are not counted");
+  auto str = colored.to_string();
+  check(str.find("\x1b[0;32mok\x1b[0m     ") != std::string::npos,
+        "colored cell is padded after its reset");
+  colored.print();
+
+  std::FILE* stream = std::tmpfile();
+  {
+    table_writer writer{{3, 3}, stream, 16};
+    for (int i{}; i < 10; ++i) {
+      writer.add_row({"ab", "{+blue}cdef{}"});
+    }
+  }
+  check(std::ftell(stream) > 0, "writer flushes on destruction");
+  std::rewind(stream);
+  char line[64]{};
+  std::fgets(line, sizeof(line), stream);
+  check(std::strncmp(line, "ab  \x1b[0;34;1mcde\x1b[0m\n", 21) == 0, "writer pads cells");
+  std::fclose(stream);
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,101 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_text.h"
+
+using namespace concol;
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  const std::string ascii(1000, 'a');
+  check(visible_width(ascii) == 1000, "ascii fast path");
+  check(truncate_to_width(ascii, 33).size() == 33, "ascii truncation");
+
+  const std::string ansi{"\x1b[0;31;1mred\x1b[0m and \x1b]0;title\a plain"};
+  check(visible_width(ansi) == 14, "ansi escapes take no columns");
+  check(truncate_to_width(ansi, 3) == "\x1b[0;31;1mred\x1b[0m",
+        "escapes after the cut are kept");
+  check(truncate_to_width(ansi, 2) == "\x1b[0;31;1mre", "cut inside text");
+
+  const std::string markup{"{+red}red{} {bogus} {"};
+  check(visible_width(markup, text_format::markup) == 13,
+        "unknown tags are visible");
+  check(truncate_to_width(markup, 3, text_format::markup) == "{+red}red{}",
+        "tags after the cut are kept");
+  check(truncate_to_width(markup, 6, text_format::markup) ==
+            "{+red}red{} {b",
+        "unknown tags can be cut");
+
+  const std::string utf8{"\xE6\x97\xA5\xE6\x9C\xAC e\xCC\x81t\xC3\xA9"};
+  check(visible_width(utf8) == 8, "wide and combining code points");
+  check(truncate_to_width(utf8, 3) == "\xE6\x97\xA5", "no split wide char");
+  check(truncate_to_width(utf8, 6) == "\xE6\x97\xA5\xE6\x9C\xAC e\xCC\x81",
+        "combining mark stays with its base");
+
+  std::string mixed{};
+  for (int i{}; i < 100; ++i) {
+    mixed += "0123456789abcdefghij\x1b[0;32m";
+  }
+  check(visible_width(mixed) == 2000, "fast path resumes after escapes");
+
+  const std::string colored{
+      "\x1b[0;31;1merror\x1b[0m: \x1b]8;;http://x\x1b\\link\x1b]8;;\a "
+      "\x1b(B0123456789abcdefghijklmnopqrstuvwxyz\x1b[K\n"};
+  const std::string plain{
+      "error: link 0123456789abcdefghijklmnopqrstuvwxyz\n"};
+  check(strip_ansi(colored) == plain, "strip_ansi");
+  std::string in_place{colored};
+  in_place.resize(strip_ansi(&in_place[0], in_place.size()));
+  check(in_place == plain, "strip_ansi in place");
+  check(strip_ansi("abc\x1b[0;3") == "abc", "unfinished sequence dropped");
+
+  bool split{true};
+  for (std::size_t cut{}; cut <= colored.size(); ++cut) {
+    ansi_stripper stripper{};
+    std::string out{};
+    stripper.feed(std::string_view{colored}.substr(0, cut), out);
+    stripper.feed(std::string_view{colored}.substr(cut), out);
+    split = split && out == plain;
+  }
+  check(split, "sequences split across chunks");
+
+  ansi_stripper bytes{};
+  std::string byte_wise{colored};
+  std::size_t size{};
+  for (std::size_t i{}; i < byte_wise.size(); ++i) {
+    char ch{byte_wise[i]};
+    if (bytes.feed(&ch, 1) == 1) byte_wise[size++] = ch;
+  }
+  byte_wise.resize(size);
+  check(byte_wise == plain, "one byte at a time in place");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,96 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol.h"
+#include "concol_text.h"
+
+using namespace concol;
+
+namespace {
+
+std::string parse(const std::string& fmt) {
+  std::string out{};
+  color::append_parsed(out, fmt.data(), fmt.size());
+  return out;
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  color::set_enabled(true);
+  const char* const names[]{"black", "blue",    "green",  "cyan",
+                            "red",   "magenta", "yellow", "white"};
+  bool builtin{true};
+  for (int i = 0; i < 8; ++i) {
+    const std::string name{names[i]};
+    builtin = builtin &&
+              parse('{' + name + '}') == color::ansi_color_code(color_type(i)) &&
+              parse("{+" + name + '}') ==
+                  color::ansi_color_code(color_type(i + 8));
+  }
+  check(builtin, "builtin tags match ansi_color_code");
+  check(parse("{}") == color::ansi_color_reset(), "reset tag");
+  check(parse("{reds}{+}{Red}") == "{reds}{+}{Red}", "unknown tags");
+  check(parse("{error}") == "{error}", "no theme");
+
+  theme{}
+      .set("error", color_type::red_bright)
+      .set("path", color_type::cyan, color_type::blue)
+      .set("red", color_type::green)
+      .apply();
+  check(parse("{error}x{}") == "\x1b[0;31;1mx\x1b[0m", "theme tag");
+  check(parse("{path}") == "\x1b[0;36;44m", "theme background");
+  check(parse("{red}") == "\x1b[0;31m", "builtin names take precedence");
+  check(parse("{warn}") == "{warn}", "missing theme tag");
+  check(visible_width("{error}abc{}", text_format::markup) == 3,
+        "theme tags have no width");
+
+  theme{}.set("error", color_type::yellow).apply();
+  check(parse("{error}") == "\x1b[0;33m", "theme replaced");
+  check(parse("{path}") == "{path}", "old names are gone");
+
+  color::set_enabled(false);
+  check(parse("{error}x{}") == "x", "disabled output drops the tag");
+
+  theme::clear();
+  check(parse("{error}") == "{error}", "theme cleared");
+
+  bool thrown{};
+  try {
+    theme{}.set("+bold", color_type::white);
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  check(thrown, "bright prefix is reserved");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
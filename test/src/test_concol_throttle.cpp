@@ -0,0 +1,138 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "check.h"
+#include "concol_throttle.h"
+
+using namespace concol;
+
+namespace {
+
+std::string read_all(std::FILE* stream) {
+  std::string str(static_cast<std::size_t>(std::ftell(stream)), '\0');
+  std::rewind(stream);
+  str.resize(std::fread(&str[0], 1, str.size(), stream));
+  return str;
+}
+
+int evaluated{};
+
+int counted() { return ++evaluated; }
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  rate_limiter limiter{1.0, 3};
+  int allowed{};
+  for (int i = 0; i < 10; ++i) allowed += limiter.allow() ? 1 : 0;
+  check(allowed == 3, "burst passes, the rest is dropped");
+  check(limiter.suppressed() == 7, "drops are counted");
+
+  rate_limiter never{0.0, 5};
+  rate_limiter rare{1e-6, 1000};
+  rate_limiter saturated{1e-12, 1000};
+  allowed = 0;
+  for (int i = 0; i < 10; ++i) {
+    allowed += never.allow() ? 1 : 0;
+    allowed += rare.allow() ? 10 : 0;
+  }
+  check(allowed == 10 * 10, "zero rate drops all, slow rate keeps its burst");
+  check(saturated.allow(), "huge intervals saturate");
+  check(never.suppressed() == 10, "zero rate counts drops");
+
+  {
+    // Leaves the site list when it goes out of scope.
+    sampler scoped{2, "scoped", 1};
+    scoped.allow();
+    scoped.allow();
+  }
+
+  sampler every_fourth{4};
+  allowed = 0;
+  for (int i = 0; i < 10; ++i) allowed += every_fourth.allow() ? 1 : 0;
+  check(allowed == 3, "one in four");
+
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+  color::set_enabled(false);
+  for (int i = 0; i < 100; ++i) {
+    CONCOL_PRINTF_RATE_LIMITED(1.0, 2, "{red}line %d{}\n", counted());
+  }
+  check(evaluated == 2, "dropped arguments are not evaluated");
+  for (int i = 0; i < 10; ++i) {
+    CONCOL_PRINTF_SAMPLED(5, "sample %d\n", i);
+  }
+  callsite_throttle::report_all();
+  callsite_throttle::report_all();
+  const auto str = read_all(stream);
+  color::set_ostream(stdout);
+  std::fclose(stream);
+  check(str.compare(0, 26, "line 1\nline 2\nsample 0\nsam") == 0,
+        "allowed messages are printed");
+  check(str.find("suppressed 98 messages from ") != std::string::npos,
+        "rate limited summary");
+  check(str.find("suppressed 8 messages from ") != std::string::npos,
+        "sampled summary");
+  check(str.find("suppressed 10 messages from :0") != std::string::npos,
+        "zero rate summary");
+  check(str.find("suppressed 7 messages from :0") != std::string::npos,
+        "standalone limiter summary");
+  std::size_t summaries{};
+  for (auto pos = str.find("suppressed"); pos != std::string::npos;
+       pos = str.find("suppressed", pos + 1)) {
+    ++summaries;
+  }
+  check(str.find("from scoped:1") == std::string::npos,
+        "destroyed sites are not reported");
+  check(summaries == 5, "summaries are reported once");
+
+  // A site that never lets anything through reports on its drop path once
+  // report_interval has passed, without report_all().
+  stream = std::tmpfile();
+  color::set_ostream(stream);
+  {
+    rate_limiter closed{0.0, 1, "closed", 2};
+    for (int i = 0; i < 5; ++i) closed.allow();
+    std::this_thread::sleep_for(
+        std::chrono::nanoseconds{callsite_throttle::report_interval} +
+        std::chrono::milliseconds{50});
+    check(!closed.allow(), "zero rate stays closed");
+  }
+  check(read_all(stream) == "suppressed 6 messages from closed:2\n",
+        "zero rate reports periodically");
+  color::set_ostream(stdout);
+  std::fclose(stream);
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
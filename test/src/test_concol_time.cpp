@@ -0,0 +1,85 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_log.h"
+
+using namespace concol;
+
+namespace {
+
+bool is_digit(char ch) { return ch >= '0' && ch <= '9'; }
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+  std::string str{};
+  timestamp::append(str);
+  check(str.size() == 24, "default layout");
+  check(str[4] == '-' && str[10] == ' ' && str[13] == ':' && str[19] == '.' &&
+            str[23] == ' ',
+        "separators");
+  check(is_digit(str[20]) && is_digit(str[21]) && is_digit(str[22]),
+        "milliseconds");
+
+  std::string second{};
+  timestamp::append(second);
+  check(second.compare(0, 19, str, 0, 19) == 0 || second > str,
+        "cached second is reused");
+
+  timestamp::set_precision(6);
+  str.clear();
+  timestamp::append(str);
+  check(str.size() == 27, "precision change invalidates the cache");
+
+  color::set_enabled(true);
+  timestamp::set_style("{+black}");
+  str.clear();
+  timestamp::append(str);
+  check(str.compare(0, 9, "\x1b[0;30;1m") == 0, "styled with a tag");
+  check(str.compare(str.size() - 5, 5, "\x1b[0m ") == 0, "style is reset");
+  str.clear();
+  timestamp::append(str, true);
+  check(str.compare(0, 8, "{+black}") == 0, "markup mode keeps the tag");
+
+  std::FILE* stream = std::tmpfile();
+  color::set_ostream(stream);
+  color::set_enabled(false);
+  logger::set_timestamp(true);
+  CONCOL_LOG_INFO("started");
+  const auto size = std::ftell(stream);
+  color::set_ostream(stdout);
+  std::fclose(stream);
+  check(size == 27 + 6 + 8, "logger writes the timestamp");
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,116 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "check.h"
+#include "concol_uring.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace concol;
+
+namespace {
+
+std::string read_all(std::FILE* stream) {
+  std::string out{};
+  std::rewind(stream);
+  char buffer[4096];
+  std::size_t size{};
+  while ((size = std::fread(buffer, 1, sizeof(buffer), stream)) != 0) {
+    out.append(buffer, size);
+  }
+  return out;
+}
+
+#ifdef __linux__
+void check_file(bool use_io_uring) {
+  std::FILE* stream = std::tmpfile();
+  std::fputs("header\n", stream);
+  std::fflush(stream);
+  std::string expected{"header\n"};
+  {
+    uring_sink sink{fileno(stream), 4096, 4, use_io_uring};
+    if (!use_io_uring) check(!sink.uses_io_uring(), "writev path forced");
+    sink.install();
+    for (int i = 0; i < 2000; ++i) {
+      color::printf("{green}line{} %d {+red}%s{}\n", i, "value");
+      expected += color::to_string("{green}line{} %d {+red}%s{}\n", i, "value");
+    }
+    // Larger than a buffer: spread over several writes.
+    const std::string large(10000, 'z');
+    color::write(large.data(), large.size());
+    expected += large;
+    sink.flush();
+    check(sink.failed() == 0 && sink.error() == 0, "no write errors");
+    check(sink.syscalls() < expected.size() / 4096 + 4, "batched syscalls");
+    color::printf("tail\n");
+    expected += "tail\n";
+  }
+  check(color::get_sink() == nullptr, "uninstalled by the destructor");
+  check(read_all(stream) == expected, use_io_uring
+                                          ? "file contents (io_uring)"
+                                          : "file contents (writev)");
+  std::fseek(stream, 0, SEEK_END);
+  check(std::ftell(stream) == long(expected.size()),
+        "file position after the sink");
+  std::fclose(stream);
+}
+#endif
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) try {
+#ifdef __linux__
+  color::set_enabled(true);
+  check_file(true);
+  check_file(false);
+
+  // Pipes are not seekable and always take the writev path.
+  int fds[2];
+  check(::pipe(fds) == 0, "pipe");
+  {
+    uring_sink sink{fds[1], 4096, 2};
+    check(!sink.uses_io_uring(), "pipe uses writev");
+    sink.write("through a pipe\n", 15);
+    sink.flush();
+  }
+  char buffer[32]{};
+  check(::read(fds[0], buffer, sizeof(buffer)) == 15 &&
+            std::string{buffer} == "through a pipe\n",
+        "pipe contents");
+  ::close(fds[0]);
+  ::close(fds[1]);
+#endif
+
+  return failures == 0 ? 0 : 1;
+} catch (...) {
+  std::cerr << "\nunexpected exception\n";
+  return 1;
+}
@@ -0,0 +1,69 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "concol_binlog.h"
+
+using namespace concol;
+
+// Expands a binary log written by concol::binary_log to stdout.
+//   concol_binlog [--plain] <file>
+int main(int argc, char *argv[]) try {
+  const char* path{};
+  bool plain{};
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--plain") == 0) {
+      plain = true;
+    } else {
+      path = argv[i];
+    }
+  }
+  if (path == nullptr) {
+    std::fprintf(stderr, "usage: %s [--plain] <file>\n", argv[0]);
+    return 2;
+  }
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    std::fprintf(stderr, "%s: cannot open %s\n", argv[0], path);
+    return 1;
+  }
+  const std::vector<unsigned char> data{std::istreambuf_iterator<char>{file},
+                                        std::istreambuf_iterator<char>{}};
+  color::set_enabled(!plain);
+  std::string out{};
+  decode_binary_log(data.data(), data.size(), out);
+  std::fwrite(out.data(), 1, out.size(), stdout);
+  return 0;
+} catch (const std::exception& e) {
+  std::fprintf(stderr, "%s\n", e.what());
+  return 1;
+}
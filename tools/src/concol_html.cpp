@@ -0,0 +1,60 @@
+/*
+
+MIT License
+
+Copyright (c) 2020 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+#include "concol_html.h"
+
+using namespace concol;
+
+// Converts colored output to an HTML document.
+//   concol_html [--markup] [<file>] > report.html
+int main(int argc, char *argv[]) try {
+  const char* path{};
+  auto format = text_format::ansi;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--markup") == 0) {
+      format = text_format::markup;
+    } else {
+      path = argv[i];
+    }
+  }
+  std::FILE* in{stdin};
+  if (path != nullptr) {
+    in = std::fopen(path, "rb");
+    if (in == nullptr) {
+      std::fprintf(stderr, "%s: cannot open %s\n", argv[0], path);
+      return 1;
+    }
+  }
+  write_html(in, stdout, format);
+  if (in != stdin) std::fclose(in);
+  return 0;
+} catch (const std::exception& e) {
+  std::fprintf(stderr, "%s\n", e.what());
+  return 1;
+}